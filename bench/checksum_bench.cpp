@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#include <deye_connector.hpp>
+#include <chrono>
+#include <iostream>
+#include <random>
+
+static constexpr std::size_t frame_size = 2048;
+static constexpr std::size_t iterations = 20'000;
+
+template<class F>
+static double nanoseconds_per_frame(std::span<const std::uint8_t> frame, F&& f)
+{
+	using clock = std::chrono::steady_clock;
+
+	volatile std::uint32_t sink{};
+
+	const auto begin = clock::now();
+	for (std::size_t i{}; i != iterations; ++i)
+	{
+		sink = sink + f(frame);
+	}
+	const auto end = clock::now();
+
+	return std::chrono::duration<double, std::nano>(end - begin).count() / iterations;
+}
+
+static void report(std::string_view name, const double reference_ns, const double optimized_ns)
+{
+	std::cout << name << ": "
+		<< reference_ns << " ns/frame -> " << optimized_ns << " ns/frame ("
+		<< reference_ns / optimized_ns << "x)\n";
+}
+
+int main()
+{
+	auto frame = std::array<std::uint8_t, frame_size>{};
+
+	auto rng = std::mt19937{ 42 };
+	std::ranges::generate(frame, [&]() { return static_cast<std::uint8_t>(rng()); });
+
+	namespace modbus = deye::detail::modbus;
+
+	const auto checksum_scalar = [](std::span<const std::uint8_t> data)
+	{
+		return std::accumulate(data.begin(), data.end(), std::uint8_t{});
+	};
+
+	for (std::size_t size{}; size <= frame.size(); ++size)
+	{
+		const auto view = std::span{ frame.data(), size };
+		if (
+			modbus::crc(view) != modbus::crc_bitwise(view) or
+			modbus::checksum(view) != checksum_scalar(view)
+		) {
+			std::cerr << "Mismatch with reference implementation at size " << size << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	report(
+		"crc",
+		nanoseconds_per_frame(frame, modbus::crc_bitwise),
+		nanoseconds_per_frame(frame, modbus::crc)
+	);
+
+	report(
+		"checksum",
+		nanoseconds_per_frame(frame, checksum_scalar),
+		nanoseconds_per_frame(frame, modbus::checksum)
+	);
+
+	return EXIT_SUCCESS;
+}
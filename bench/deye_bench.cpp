@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#include <deye_connector.hpp>
+#include <deye_simulator.hpp>
+#include <linux_tcp_socket.hpp>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+
+static constexpr deye::serial_number_type serial_number = 69420;
+static constexpr std::uint16_t loopback_port = 48899;
+
+// Minimum time every benchmark runs for, iterations are doubled until it is reached.
+static constexpr auto min_duration = std::chrono::milliseconds{ 200 };
+
+template<class T>
+static void keep(const T& value)
+{
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * @brief In-memory socket that swallows every request and answers with the same prepared bytes.
+ */
+struct memory_socket
+{
+	static inline std::span<const std::uint8_t> response{};
+
+	std::error_code connect(const char*, std::uint16_t) { return {}; }
+	std::error_code disconnect() { return {}; }
+	void set_timeouts(std::chrono::milliseconds, std::chrono::milliseconds, std::chrono::milliseconds) {}
+
+	std::error_code send(std::span<const std::uint8_t> data)
+	{
+		keep(data);
+		return {};
+	}
+
+	std::error_code receive(std::span<std::uint8_t> data)
+	{
+		std::copy_n(response.begin(), data.size(), data.begin());
+		return {};
+	}
+
+	std::expected<std::size_t, std::error_code> receive_some(std::span<std::uint8_t> data)
+	{
+		const auto size = std::min(data.size(), response.size());
+		std::copy_n(response.begin(), size, data.begin());
+		return size;
+	}
+};
+
+// Exposes the frame level members the public reads are built from.
+struct frame_connector : deye::connector<memory_socket>
+{
+	using connector::connector;
+	using connector::send_modbus_frame;
+	using connector::receive_modbus_frame;
+};
+
+struct result
+{
+	std::string name;
+	std::uint64_t iterations;
+	double ns_per_op;
+};
+
+static result run(std::string name, const std::function<void()>& op)
+{
+	using clock = std::chrono::steady_clock;
+
+	for (std::uint64_t iterations = 1;; iterations *= 2)
+	{
+		const auto begin = clock::now();
+		for (std::uint64_t i{}; i != iterations; ++i)
+		{
+			op();
+		}
+		const auto elapsed = clock::now() - begin;
+
+		if (elapsed >= min_duration)
+		{
+			return {
+				std::move(name),
+				iterations,
+				std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations)
+			};
+		}
+	}
+}
+
+static void print_json(const std::vector<result>& results)
+{
+	std::cout << "{\n";
+#ifdef DEYE_REDUNDANT_ERROR_CHECKS
+	std::cout << "\t\"redundant_error_checks\": true,\n";
+#else
+	std::cout << "\t\"redundant_error_checks\": false,\n";
+#endif
+	std::cout << "\t\"benchmarks\": [\n";
+	for (std::size_t i{}; i != results.size(); ++i)
+	{
+		const auto& r = results[i];
+		std::cout << "\t\t{ \"name\": \"" << r.name
+			<< "\", \"iterations\": " << r.iterations
+			<< ", \"ns_per_op\": " << r.ns_per_op << " }"
+			<< (i + 1 != results.size() ? ",\n" : "\n");
+	}
+	std::cout << "\t]\n}\n";
+}
+
+static void bench_frames(std::vector<result>& results)
+{
+	namespace modbus = deye::detail::modbus;
+
+	auto connector = frame_connector{ serial_number };
+
+	results.push_back(run("send_modbus_frame/read_request", [&]()
+	{
+		const auto sequence_number = connector.send_modbus_frame(
+			modbus::read_request_size,
+			[](std::span<std::uint8_t> req) -> std::error_code
+			{
+				return modbus::encode_read_request(req, 0x0003, 125);
+			}
+		);
+		keep(sequence_number);
+	}));
+
+	auto simulator = deye::simulator{ serial_number };
+
+	for (const std::uint16_t register_count : { 1, 125 })
+	{
+		// Ask the simulator for a real response to replay.
+		auto request = std::array<std::uint8_t, modbus::request_frame_size(modbus::read_request_size)>{};
+		const auto request_frame = modbus::encode_frame(
+			request, serial_number, 0, modbus::read_request_size,
+			[&](std::span<std::uint8_t> req) { return modbus::encode_read_request(req, 0x0003, register_count); }
+		);
+		const auto response = simulator.respond(*request_frame);
+		const auto response_copy = std::vector<std::uint8_t>(response->begin(), response->end());
+		memory_socket::response = response_copy;
+
+		const auto receive = [&]()
+		{
+			return connector.receive_modbus_frame(
+				[](std::uint8_t) { return true; },
+				[&](std::uint8_t, std::span<std::uint8_t> res) -> std::error_code
+				{
+					const auto registers = modbus::decode_read_response(res, register_count);
+					keep(registers);
+					return registers ? std::error_code{} : registers.error();
+				}
+			);
+		};
+
+		if (const auto error = receive())
+		{
+			std::cerr << "Replayed response is invalid: " << error.message() << std::endl;
+			std::exit(EXIT_FAILURE);
+		}
+
+		results.push_back(run("receive_modbus_frame/" + std::to_string(register_count) + "_registers", [&]()
+		{
+			keep(receive());
+		}));
+	}
+}
+
+static void bench_bytes(std::vector<result>& results)
+{
+	namespace bytes = deye::detail::bytes;
+
+	auto buffer = std::array<std::uint8_t, 8>{};
+	auto value = std::uint64_t{ 0x0123456789ABCDEF };
+
+	results.push_back(run("bytes::from/u16_big", [&]()
+	{
+		keep(bytes::from<std::uint16_t, std::endian::big>(static_cast<std::uint16_t>(value++), buffer, std::size_t{}));
+		keep(buffer);
+	}));
+
+	results.push_back(run("bytes::from/u32_little", [&]()
+	{
+		keep(bytes::from<std::uint32_t, std::endian::little>(static_cast<std::uint32_t>(value++), buffer, std::size_t{}));
+		keep(buffer);
+	}));
+
+	results.push_back(run("bytes::to/u16_big", [&]()
+	{
+		keep(buffer);
+		keep(bytes::to<std::uint16_t, std::endian::big>(buffer, std::size_t{}));
+	}));
+
+	results.push_back(run("bytes::to/u32_little", [&]()
+	{
+		keep(buffer);
+		keep(bytes::to<std::uint32_t, std::endian::little>(buffer, std::size_t{}));
+	}));
+}
+
+static void bench_interpret(std::vector<result>& results)
+{
+	const auto simulator = deye::simulator{ serial_number };
+
+	static constexpr auto type_names = std::array{ "registers", "integer", "physical", "enumeration" };
+
+	for (std::size_t type{}; type != type_names.size(); ++type)
+	{
+		// The first sensor of every representation stands in for all of them.
+		const auto sensor = std::ranges::find_if(deye::config::sensors, [&](const deye::sensor_meta& meta)
+		{
+			return static_cast<std::size_t>(meta.rep.type()) == type + 1;
+		});
+
+		if (sensor == deye::config::sensors.end())
+		{
+			continue;
+		}
+
+		const auto registers = simulator.registers().subspan(sensor->begin_address, sensor->register_count);
+
+		results.push_back(run(std::string{ "interpret/" } + type_names[type], [&]()
+		{
+			keep(registers);
+			keep(sensor->rep.interpret(registers));
+		}));
+	}
+}
+
+static void bench_loopback(std::vector<result>& results)
+{
+	using enum deye::config::sensor_id;
+
+	static constexpr auto sensor_ids = std::array{
+		production_today, phase_1_voltage, ac_temperature, pv1_voltage,
+		total_power, battery_soc, pv1_power, total_production
+	};
+
+	auto simulator = deye::simulator{ serial_number };
+
+	auto server = std::thread([&]()
+	{
+		linux_tcp_socket socket;
+		if (const auto error = socket.listen(loopback_port))
+		{
+			std::cerr << "Error while listening: " << error.message() << std::endl;
+			return;
+		}
+		[[maybe_unused]] const auto error = simulator.serve(socket);
+	});
+
+	auto connector = deye::connector<linux_tcp_socket>{ serial_number };
+
+	auto error = std::error_code{};
+	for (int attempt{}; attempt != 50; ++attempt)
+	{
+		if (not (error = connector.connect("127.0.0.1", loopback_port)))
+		{
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds{ 10 });
+	}
+
+	if (error)
+	{
+		std::cerr << "Error while connecting: " << error.message() << std::endl;
+		std::exit(EXIT_FAILURE);
+	}
+
+	auto values = std::array<deye::sensor_value, sensor_ids.size()>{};
+
+	results.push_back(run("read_sensors/loopback", [&]()
+	{
+		keep(connector.read_sensors(sensor_ids, values));
+		keep(values);
+	}));
+
+	auto column_values = std::array<double, sensor_ids.size()>{};
+	auto column_unit_ids = std::array<deye::config::physical_unit_id, sensor_ids.size()>{};
+
+	results.push_back(run("read_sensors/loopback_columns", [&]()
+	{
+		keep(connector.read_sensors(sensor_ids, deye::sensor_columns{ column_values, column_unit_ids }));
+		keep(column_values);
+	}));
+
+	results.push_back(run("read_sensors/loopback_static", [&]()
+	{
+		keep(connector.read_sensors<sensor_ids>());
+	}));
+
+	[[maybe_unused]] const auto disconnect_error = connector.disconnect();
+	server.join();
+}
+
+int main()
+{
+	auto results = std::vector<result>{};
+
+	bench_frames(results);
+	bench_bytes(results);
+	bench_interpret(results);
+	bench_loopback(results);
+
+	print_json(results);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,392 @@
+/*
+ * Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#include <asio_tcp_socket.hpp>
+#include <deye_connector.hpp>
+#include <deye_simulator.hpp>
+#include <linux_tcp_socket.hpp>
+#include <linux_uring_fleet.hpp>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <thread>
+#include <unordered_map>
+
+static constexpr deye::serial_number_type serial_number = 1234567890;
+
+static constexpr auto sensor_ids = std::array{
+	deye::config::sensor_id::production_today,
+	deye::config::sensor_id::phase_1_voltage,
+	deye::config::sensor_id::ac_temperature,
+	deye::config::sensor_id::pv1_voltage,
+	deye::config::sensor_id::total_power,
+	deye::config::sensor_id::battery_soc,
+	deye::config::sensor_id::pv1_power
+};
+
+/**
+ * @brief Serves any number of simulated loggers on one port from a single epoll thread.
+ *
+ * All connections share one `deye::simulator`, the benchmark polls every device with the same serial number.
+ */
+class local_fleet_simulator
+{
+public:
+	local_fleet_simulator();
+
+	[[nodiscard]] std::uint16_t port() const;
+
+	~local_fleet_simulator();
+
+private:
+	void run();
+
+	void handle(int fd, std::vector<std::uint8_t>& input);
+
+	deye::simulator m_logger{ serial_number };
+	int m_listen_fd{ -1 }, m_epoll_fd{ -1 }, m_stop_fd[2]{ -1, -1 };
+	std::uint16_t m_port{};
+	std::thread m_thread;
+};
+
+local_fleet_simulator::local_fleet_simulator()
+{
+	m_listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	socklen_t addr_size = sizeof(addr);
+	if (
+		m_listen_fd < 0 or
+		bind(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 or
+		listen(m_listen_fd, SOMAXCONN) != 0 or
+		getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&addr), &addr_size) != 0 or
+		pipe(m_stop_fd) != 0
+	) {
+		std::perror("simulator");
+		std::exit(EXIT_FAILURE);
+	}
+
+	m_port = ntohs(addr.sin_port);
+
+	m_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	for (const int fd : { m_listen_fd, m_stop_fd[0] })
+	{
+		epoll_event event{};
+		event.events = EPOLLIN;
+		event.data.fd = fd;
+		epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+	}
+
+	m_thread = std::thread(&local_fleet_simulator::run, this);
+}
+
+std::uint16_t local_fleet_simulator::port() const
+{
+	return m_port;
+}
+
+void local_fleet_simulator::run()
+{
+	auto inputs = std::unordered_map<int, std::vector<std::uint8_t>>{};
+	auto events = std::array<epoll_event, 64>{};
+	auto chunk = std::array<std::uint8_t, 4096>{};
+
+	while (true)
+	{
+		const int ready = epoll_wait(m_epoll_fd, events.data(), events.size(), -1);
+
+		for (int i{}; i < ready; ++i)
+		{
+			const int fd = events[i].data.fd;
+
+			if (fd == m_stop_fd[0])
+			{
+				for (const auto& [conn_fd, input] : inputs)
+				{
+					close(conn_fd);
+				}
+				return;
+			}
+
+			if (fd == m_listen_fd)
+			{
+				int conn_fd;
+				while ((conn_fd = accept4(m_listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+				{
+					// Without this the pipelined responses wait for the delayed acks of the client.
+					int no_delay = true;
+					setsockopt(conn_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+					epoll_event event{};
+					event.events = EPOLLIN;
+					event.data.fd = conn_fd;
+					epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, conn_fd, &event);
+					inputs[conn_fd];
+				}
+				continue;
+			}
+
+			auto& input = inputs[fd];
+
+			const auto received = recv(fd, chunk.data(), chunk.size(), 0);
+			if (received <= 0)
+			{
+				if (received < 0 and errno == EAGAIN)
+				{
+					continue;
+				}
+				close(fd);
+				inputs.erase(fd);
+				continue;
+			}
+
+			input.insert(input.end(), chunk.begin(), chunk.begin() + received);
+			handle(fd, input);
+		}
+	}
+}
+
+void local_fleet_simulator::handle(const int fd, std::vector<std::uint8_t>& input)
+{
+	auto output = std::vector<std::uint8_t>{};
+	auto offset = std::size_t{};
+
+	while (input.size() - offset >= deye::detail::modbus::header_size)
+	{
+		const auto frame = std::span{ input }.subspan(offset);
+
+		const auto frame_size = deye::simulator::request_size(frame);
+		if (not frame_size or frame.size() < *frame_size)
+		{
+			break;
+		}
+
+		if (const auto response = m_logger.respond(frame.first(*frame_size)))
+		{
+			output.insert(output.end(), response->begin(), response->end());
+		}
+
+		offset += *frame_size;
+	}
+
+	input.erase(input.begin(), input.begin() + offset);
+
+	// Responses are small enough to always fit into the socket buffer.
+	if (not output.empty())
+	{
+		[[maybe_unused]] const auto sent = send(fd, output.data(), output.size(), MSG_NOSIGNAL);
+	}
+}
+
+local_fleet_simulator::~local_fleet_simulator()
+{
+	[[maybe_unused]] const auto written = write(m_stop_fd[1], "", 1);
+	m_thread.join();
+	close(m_listen_fd);
+	close(m_epoll_fd);
+	close(m_stop_fd[0]);
+	close(m_stop_fd[1]);
+}
+
+
+/**
+ * @brief Counts the socket calls of a blocking connector, each one is at least one system call.
+ */
+template<class Socket>
+struct counting_socket : Socket
+{
+	static inline std::uint64_t calls{};
+
+	[[nodiscard]] std::error_code send(std::span<const std::uint8_t> data)
+	{
+		++calls;
+		return Socket::send(data);
+	}
+
+	[[nodiscard]] std::error_code receive(std::span<std::uint8_t> data)
+	{
+		++calls;
+		return Socket::receive(data);
+	}
+
+	[[nodiscard]] std::expected<std::size_t, std::error_code> receive_some(std::span<std::uint8_t> data)
+	{
+		++calls;
+		return Socket::receive_some(data);
+	}
+};
+
+struct measurement
+{
+	std::chrono::nanoseconds wall{}, cpu{};
+	std::uint64_t syscalls{}, context_switches{}, errors{};
+};
+
+static std::chrono::nanoseconds thread_cpu_time()
+{
+	timespec ts{};
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return std::chrono::seconds{ ts.tv_sec } + std::chrono::nanoseconds{ ts.tv_nsec };
+}
+
+static std::uint64_t context_switches()
+{
+	rusage usage{};
+	getrusage(RUSAGE_THREAD, &usage);
+	return static_cast<std::uint64_t>(usage.ru_nvcsw + usage.ru_nivcsw);
+}
+
+template<class F>
+static measurement measure(F&& poll_fleet, std::size_t cycles)
+{
+	auto result = measurement{};
+
+	const auto wall_begin = std::chrono::steady_clock::now();
+	const auto cpu_begin = thread_cpu_time();
+	const auto switches_begin = context_switches();
+
+	for (std::size_t i{}; i != cycles; ++i)
+	{
+		poll_fleet(result);
+	}
+
+	result.wall = std::chrono::steady_clock::now() - wall_begin;
+	result.cpu = thread_cpu_time() - cpu_begin;
+	result.context_switches = context_switches() - switches_begin;
+
+	return result;
+}
+
+template<class Socket>
+static measurement bench_connectors(std::uint16_t port, std::size_t device_count, std::size_t cycles)
+{
+	auto connectors = std::vector<std::unique_ptr<deye::connector<counting_socket<Socket>>>>{};
+	for (std::size_t i{}; i != device_count; ++i)
+	{
+		auto& conn = connectors.emplace_back(std::make_unique<deye::connector<counting_socket<Socket>>>(serial_number));
+		if (const auto error = conn->connect("127.0.0.1", port); error)
+		{
+			std::cerr << "connect failed: " << error.message() << std::endl;
+			std::exit(EXIT_FAILURE);
+		}
+	}
+
+	auto values = std::array<deye::sensor_value, sensor_ids.size()>{};
+
+	const auto calls_begin = counting_socket<Socket>::calls;
+
+	auto result = measure([&](measurement& m)
+	{
+		// One thread polls every device in turn, the same work the uring fleet does.
+		for (auto& conn : connectors)
+		{
+			m.errors += static_cast<bool>(conn->read_sensors(sensor_ids, values));
+		}
+	}, cycles);
+
+	result.syscalls = counting_socket<Socket>::calls - calls_begin;
+
+	return result;
+}
+
+static measurement bench_uring(std::uint16_t port, std::size_t device_count, std::size_t cycles, bool& fixed_buffers)
+{
+	auto devices = std::vector<deye::fleet_device>{};
+	for (std::size_t i{}; i != device_count; ++i)
+	{
+		devices.push_back({ "127.0.0.1", port, serial_number, { sensor_ids.begin(), sensor_ids.end() } });
+	}
+
+	auto fleet = deye::uring_fleet{ std::move(devices) };
+
+	auto errors = std::uint64_t{};
+	const auto on_poll = deye::uring_fleet::callback_type{
+		[&](std::size_t, std::span<const deye::sensor_value>, const std::error_code error)
+		{
+			errors += static_cast<bool>(error);
+		}
+	};
+
+	// The first cycle connects all devices.
+	if (const auto error = fleet.poll(on_poll); error or errors != 0)
+	{
+		std::cerr << "uring fleet failed: " << (error ? error.message() : "device error") << std::endl;
+		std::exit(EXIT_FAILURE);
+	}
+
+	const auto enters_begin = fleet.stats().enters;
+
+	auto result = measure([&](measurement&)
+	{
+		if (const auto error = fleet.poll(on_poll); error)
+		{
+			std::cerr << "uring fleet failed: " << error.message() << std::endl;
+			std::exit(EXIT_FAILURE);
+		}
+	}, cycles);
+
+	result.syscalls = fleet.stats().enters - enters_begin;
+	result.errors = errors;
+	fixed_buffers = fleet.stats().fixed_buffers;
+
+	return result;
+}
+
+static void report(std::string_view name, const measurement& m, const std::size_t polls)
+{
+	const auto per_poll = static_cast<double>(polls);
+	std::cout << name << ": "
+		<< std::chrono::duration<double, std::micro>(m.wall).count() / per_poll << " us/poll, "
+		<< std::chrono::duration<double, std::milli>(m.cpu).count() * 1000.0 / per_poll << " ms cpu/1000 polls, "
+		<< static_cast<double>(m.syscalls) / per_poll << " syscalls/poll, "
+		<< static_cast<double>(m.context_switches) / per_poll << " context switches/poll, "
+		<< m.errors << " errors\n";
+}
+
+static std::size_t parse_arg(const char* arg, const std::size_t fallback)
+{
+	auto value = fallback;
+	if (arg)
+	{
+		std::from_chars(arg, arg + std::strlen(arg), value);
+	}
+	return value;
+}
+
+int main(int argc, char* argv[])
+{
+	const auto device_count = parse_arg(argc > 1 ? argv[1] : nullptr, 64);
+	const auto cycles = parse_arg(argc > 2 ? argv[2] : nullptr, 200);
+	const auto polls = device_count * cycles;
+
+	auto simulator = local_fleet_simulator{};
+
+	std::cout << device_count << " devices, " << cycles << " cycles, "
+		<< sensor_ids.size() << " sensors per device\n";
+
+	report("asio ", bench_connectors<asio_tcp_socket>(simulator.port(), device_count, cycles), polls);
+	report("epoll", bench_connectors<linux_tcp_socket>(simulator.port(), device_count, cycles), polls);
+
+	auto fixed_buffers = false;
+	const auto uring = bench_uring(simulator.port(), device_count, cycles, fixed_buffers);
+	report(fixed_buffers ? "uring" : "uring (no fixed buffers)", uring, polls);
+
+	return EXIT_SUCCESS;
+}
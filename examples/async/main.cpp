@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#include <deye_connector.hpp>
+#include <asio_async_connector.hpp>
+#include <iostream>
+
+struct logger
+{
+	const char* ip;
+	uint16_t port;
+	uint32_t serial_number;
+};
+
+static constexpr auto loggers = std::array{
+	logger{ "1.1.1.1", 8899, 69420 },
+	logger{ "1.1.1.2", 8899, 69421 },
+	logger{ "1.1.1.3", 8899, 69422 }
+};
+
+static constexpr auto poll_interval = std::chrono::seconds{ 5 };
+
+using enum deye::config::sensor_id;
+
+static constexpr auto my_sensors = std::array{
+	running_status, production_today, ac_active_power,
+	pv1_power, pv2_power, battery_soc, battery_power
+};
+
+boost::asio::awaitable<void> poll(logger info)
+{
+	auto executor = co_await boost::asio::this_coro::executor;
+
+	deye::async_connector connector(executor, info.serial_number);
+
+	if (const auto error = co_await connector.connect(info.ip, info.port))
+	{
+		std::cerr << info.ip << ": Error while connecting: " << error.message() << std::endl;
+		co_return;
+	}
+
+	auto timer = boost::asio::steady_timer{ executor };
+	auto values = std::array<deye::sensor_value, my_sensors.size()>{};
+
+	while (true)
+	{
+		timer.expires_after(poll_interval);
+
+		if (const auto error = co_await connector.read_sensors(my_sensors, values))
+		{
+			std::cerr << info.ip << ": Error while reading: " << error.message() << std::endl;
+			co_return;
+		}
+
+		for (const auto [ sensor_id, sensor_value ] : std::views::zip(my_sensors, values))
+		{
+			std::cout << info.ip << ": " << deye::sensor_meta_by_id(sensor_id)->name << ": ";
+
+			sensor_value.visit(
+				[&](const deye::sensor_value::physical& physical)
+				{
+					std::cout << physical.value << " " << deye::physical_unit_by_id(physical.unit_id)->symbol;
+				},
+				[&](const deye::sensor_value::enumeration& enumeration)
+				{
+					std::cout << deye::enumeration_by_id(enumeration.enum_id)->names[enumeration.index];
+				},
+				[&](const auto&)
+				{
+					std::cout << "<unexpected>";
+				}
+			);
+
+			std::cout << '\n';
+		}
+
+		co_await timer.async_wait(boost::asio::use_awaitable);
+	}
+}
+
+int main()
+{
+	// A single thread serves all loggers.
+	boost::asio::io_context ctx;
+
+	for (const auto& info : loggers)
+	{
+		boost::asio::co_spawn(ctx, poll(info), boost::asio::detached);
+	}
+
+	ctx.run();
+
+	return EXIT_SUCCESS;
+}
@@ -29,8 +29,6 @@ int main()
 		ac_temperature, total_production
 	};
 
-	std::array<deye::sensor_value, my_sensors.size()> values{};
-
 	deye::connector<asio_tcp_socket> connector(serial_number);
 
 	std::cout << "Connecting to " << ip << ':' << port << "...\n";
@@ -61,13 +59,15 @@ int main()
 		return EXIT_FAILURE;
 	}
 
-	if (const auto error = connector.read_sensors(my_sensors, values))
+	// The read plan for a fixed set of sensors is computed at compile time.
+	const auto values = connector.read_sensors<my_sensors>();
+	if (not values)
 	{
-		std::cerr << "Error while reading: " << error.message() << std::endl;
+		std::cerr << "Error while reading: " << values.error().message() << std::endl;
 		return EXIT_FAILURE;
 	}
 
-	for (const auto [ sensor_id, sensor_value ] : std::views::zip(my_sensors, values))
+	for (const auto [ sensor_id, sensor_value ] : std::views::zip(my_sensors, *values))
 	{
 		const auto sensor_meta = *deye::sensor_meta_by_id(sensor_id);
 
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#include <deye_simulator.hpp>
+#include <linux_tcp_socket.hpp>
+#include <charconv>
+#include <iostream>
+
+template<typename T>
+static T parse_arg(const int argc, char* argv[], const int index, const T fallback)
+{
+	auto value = fallback;
+	if (index < argc)
+	{
+		std::from_chars(argv[index], argv[index] + std::strlen(argv[index]), value);
+	}
+	return value;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 and std::string_view{ argv[1] } == "--help")
+	{
+		std::cout << "usage: " << argv[0]
+			<< " [port] [serial number] [latency ms] [jitter ms] [partial write probability] [error frame probability]\n";
+		return EXIT_SUCCESS;
+	}
+
+	const auto port = parse_arg<std::uint16_t>(argc, argv, 1, 8899);
+	const auto serial_number = parse_arg<deye::serial_number_type>(argc, argv, 2, 69420);
+
+	auto faults = deye::simulator_faults{
+		.latency = std::chrono::milliseconds{ parse_arg<int>(argc, argv, 3, 0) },
+		.jitter = std::chrono::milliseconds{ parse_arg<int>(argc, argv, 4, 0) },
+		.partial_write_probability = parse_arg<double>(argc, argv, 5, 0.0),
+		.error_frame_probability = parse_arg<double>(argc, argv, 6, 0.0)
+	};
+
+	auto simulator = deye::simulator{ serial_number, faults };
+
+	std::cout << "Simulating logger " << serial_number << " on port " << port << '\n';
+
+	// Like a real logger, one client is served at a time.
+	while (true)
+	{
+		linux_tcp_socket socket;
+
+		if (const auto error = socket.listen(port))
+		{
+			std::cerr << "Error while listening: " << error.message() << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		std::cout << "Client connected\n";
+
+		const auto error = simulator.serve(socket);
+
+		const auto& stats = simulator.stats();
+		std::cout << "Client disconnected (" << error.message() << "): "
+			<< stats.requests << " requests, "
+			<< stats.reads << " reads, "
+			<< stats.writes << " writes, "
+			<< stats.error_frames << " error frames, "
+			<< stats.partial_writes << " partial writes\n";
+	}
+}
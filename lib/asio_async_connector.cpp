@@ -0,0 +1,167 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+
+#include "asio_async_connector.hpp"
+
+#include <boost/asio/ip/address.hpp>
+
+namespace asio = boost::asio;
+using tcp = asio::ip::tcp;
+
+deye::async_connector::async_connector(asio::any_io_executor executor, const serial_number_type serial_number) :
+	m_socket{ executor }, m_deadline{ std::move(executor) }, m_frame_template{ serial_number }, m_serial_number{ serial_number } {}
+
+asio::awaitable<std::error_code> deye::async_connector::connect(const char* host, const std::uint16_t port) {
+	boost::system::error_code error;
+
+	const auto ip = asio::ip::make_address(host, error);
+	if (error) co_return error;
+
+	if (m_socket.is_open()) {
+		if (const auto disconnect_error = disconnect()) co_return disconnect_error;
+	}
+
+	m_decoder.reset();
+
+	const auto connect_error = co_await with_deadline(m_timeouts.connect, [&]() -> awaitable<boost::system::error_code> {
+		boost::system::error_code async_error;
+		co_await m_socket.async_connect(
+			tcp::endpoint(ip, port),
+			asio::redirect_error(asio::use_awaitable, async_error)
+		);
+		co_return async_error;
+	});
+
+	// A failed attempt leaves the socket open, the next attempt has to start from a closed one.
+	if (connect_error and m_socket.is_open()) m_socket.close(error);
+
+	co_return connect_error;
+}
+
+std::error_code deye::async_connector::disconnect() {
+	m_decoder.reset();
+
+	boost::system::error_code error;
+	m_socket.shutdown(tcp::socket::shutdown_both, error);
+
+	// A peer that already went away (e.g. after a timeout) must not keep the socket open.
+	if (error == asio::error::not_connected) error = {};
+
+	boost::system::error_code close_error;
+	m_socket.close(close_error);
+
+	return error ? error : close_error;
+}
+
+deye::serial_number_type& deye::async_connector::serial_number() {
+	return m_serial_number;
+}
+
+const deye::serial_number_type& deye::async_connector::serial_number() const {
+	return m_serial_number;
+}
+
+deye::read_plan_config& deye::async_connector::read_plan() {
+	return m_read_plan;
+}
+
+const deye::read_plan_config& deye::async_connector::read_plan() const {
+	return m_read_plan;
+}
+
+void deye::async_connector::set_timeouts(const timeout_config& timeouts) {
+	m_timeouts = timeouts;
+}
+
+const deye::timeout_config& deye::async_connector::timeouts() const {
+	return m_timeouts;
+}
+
+asio::awaitable<std::expected<std::span<std::uint16_t>, std::error_code>> deye::async_connector::read_registers(
+	const std::uint16_t begin_address,
+	const std::uint16_t register_count
+) {
+	auto register_view = std::span<std::uint16_t>{};
+
+	const auto write_request = [&](std::span<std::uint8_t> req) -> std::error_code {
+		return detail::modbus::encode_read_request(req, begin_address, register_count);
+	};
+
+	const auto read_request = [&](std::span<std::uint8_t> res) -> std::error_code {
+		const auto registers = detail::modbus::decode_read_response(res, register_count);
+		if (not registers) return registers.error();
+		register_view = *registers;
+		return {};
+	};
+
+	if (const auto error = co_await modbus_request(detail::modbus::read_request_size, write_request, read_request)) {
+		co_return std::unexpected{ error };
+	}
+
+	co_return register_view;
+}
+
+asio::awaitable<std::expected<deye::sensor_value, std::error_code>> deye::async_connector::read_sensor(
+	const config::sensor_id id
+) {
+	using connector_error::make_error_code;
+
+	const auto sensor_meta = sensor_meta_by_id(id);
+	if (not sensor_meta) {
+		co_return std::unexpected{ make_error_code(connector_error::codes::unknown_sensor) };
+	}
+
+	const auto registers = co_await read_registers(sensor_meta->begin_address, sensor_meta->register_count);
+	if (not registers) {
+		co_return std::unexpected{ registers.error() };
+	}
+
+	co_return sensor_meta->rep.interpret(*registers);
+}
+
+asio::awaitable<std::error_code> deye::async_connector::read_sensors(
+	std::span<const config::sensor_id> sensor_ids,
+	std::span<sensor_value> sensor_values
+) {
+	using connector_error::make_error_code;
+
+	if (sensor_ids.size() != sensor_values.size()) {
+		co_return make_error_code(connector_error::codes::num_sensors_values_mismatch);
+	}
+
+	const auto requested = detail::read_planner::requested_sensors(config::sensors, sensor_ids);
+	if (not requested) {
+		co_return requested.error();
+	}
+
+	// The planner is synchronous, so the ranges are collected before awaiting the reads.
+	auto ranges = std::array<register_range, config::sensors.size()>{};
+	auto range_count = std::size_t{};
+
+	[[maybe_unused]] const auto planned = detail::read_planner::for_each_range(
+		config::sensors,
+		[&](const std::size_t index) { return (*requested)[index]; },
+		m_read_plan,
+		[&](const register_range& range) -> std::error_code {
+			ranges[range_count++] = range;
+			return {};
+		}
+	);
+
+	for (const auto& range : std::span{ ranges.data(), range_count }) {
+		const auto registers = co_await read_registers(range.begin_address, range.register_count);
+		if (not registers) {
+			co_return registers.error();
+		}
+
+		if (const auto error = detail::read_planner::decode_range(config::sensors, sensor_ids, sensor_values, range, *registers)) {
+			co_return error;
+		}
+	}
+
+	co_return std::error_code{};
+}
@@ -0,0 +1,250 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <system_error>
+#include <cstdint>
+#include <span>
+
+#include <boost/asio.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+
+namespace deye
+{
+
+/**
+ * @brief Coroutine based counterpart of `connector` running on an asio executor.
+ *
+ * All operations are awaitables, so a single thread can serve many loggers at once.
+ * Spans passed to an operation have to outlive the awaited operation.
+ */
+class async_connector
+{
+public:
+	template<typename T>
+	using awaitable = boost::asio::awaitable<T>;
+
+	async_connector(boost::asio::any_io_executor executor, serial_number_type serial_number);
+
+	[[nodiscard]] awaitable<std::error_code> connect(const char* host, std::uint16_t port);
+
+	[[nodiscard]] awaitable<std::expected<sensor_value, std::error_code>> read_sensor(config::sensor_id id);
+
+	[[nodiscard]] awaitable<std::error_code> read_sensors(std::span<const config::sensor_id> sensor_ids, std::span<sensor_value> values);
+
+	[[nodiscard]] std::error_code disconnect();
+
+	[[nodiscard]] serial_number_type& serial_number();
+	[[nodiscard]] const serial_number_type& serial_number() const;
+
+	[[nodiscard]] read_plan_config& read_plan();
+	[[nodiscard]] const read_plan_config& read_plan() const;
+
+	/**
+	 * @brief Sets the deadlines of the socket operations, effective with the next operation.
+	 *
+	 * A timed out operation fails with `connector_error::codes::operation_timed_out`.
+	 * Since a frame may have been transferred partially the connection should be reestablished afterwards.
+	 */
+	void set_timeouts(const timeout_config& timeouts);
+	[[nodiscard]] const timeout_config& timeouts() const;
+
+protected:
+	[[nodiscard]] awaitable<std::expected<std::span<std::uint16_t>, std::error_code>> read_registers(std::uint16_t begin_address, std::uint16_t register_count);
+
+	template<class F, class G>
+	[[nodiscard]] awaitable<std::error_code> modbus_request(std::size_t data_size, F&& write_request, G&& read_request);
+
+	/**
+	 * @return The sequence number the frame was sent with.
+	 */
+	template<class F>
+	[[nodiscard]] awaitable<std::expected<std::uint8_t, std::error_code>> send_modbus_frame(std::size_t data_size, F&& write_request);
+
+	/**
+	 * @param is_awaited Called with the sequence number of every received frame, frames it rejects get dropped.
+	 * @param read_request Called with the sequence number of the frame and its modbus response.
+	 */
+	template<class P, class F>
+	[[nodiscard]] awaitable<std::error_code> receive_modbus_frame(P&& is_awaited, F&& read_request);
+
+	static constexpr std::size_t buffer_size = 2048;
+
+private:
+	/**
+	 * @brief Awaits `operation` and cancels it on the socket once `timeout` expired, zero waits forever.
+	 *
+	 * @param operation Returns an awaitable of the `boost::system::error_code` of one socket operation.
+	 */
+	template<class F>
+	[[nodiscard]] awaitable<std::error_code> with_deadline(std::chrono::milliseconds timeout, F&& operation);
+
+	boost::asio::ip::tcp::socket m_socket;
+	boost::asio::steady_timer m_deadline;
+	std::array<std::uint8_t, buffer_size> m_buffer{};
+	detail::modbus::frame_template m_frame_template{};
+	frame_decoder<buffer_size> m_decoder{};
+	serial_number_type m_serial_number{};
+	std::uint8_t m_sequence_number{};
+	read_plan_config m_read_plan{};
+	timeout_config m_timeouts{};
+};
+
+} // namespace deye
+
+
+template<class F, class G>
+boost::asio::awaitable<std::error_code> deye::async_connector::modbus_request(
+	std::size_t data_size,
+	F&& write_request,
+	G&& read_request
+) {
+	const auto sent_sequence_number = co_await send_modbus_frame(data_size, std::forward<F>(write_request));
+	if (not sent_sequence_number)
+	{
+		co_return sent_sequence_number.error();
+	}
+
+	co_return co_await receive_modbus_frame(
+		[&](const std::uint8_t sequence_number) { return sequence_number == *sent_sequence_number; },
+		[&](std::uint8_t, std::span<std::uint8_t> response) { return read_request(response); }
+	);
+}
+
+template<class F>
+boost::asio::awaitable<std::expected<std::uint8_t, std::error_code>> deye::async_connector::send_modbus_frame(
+	std::size_t data_size,
+	F&& write_request
+) {
+	namespace asio = boost::asio;
+
+	const auto sequence_number = ++m_sequence_number;
+
+	if (m_frame_template.serial_number() != m_serial_number)
+	{
+		m_frame_template = detail::modbus::frame_template{ m_serial_number };
+	}
+
+	const auto frame = m_frame_template.encode(
+		m_buffer,
+		sequence_number,
+		data_size,
+		std::forward<F>(write_request)
+	);
+
+	if (not frame)
+	{
+		co_return std::unexpected{ frame.error() };
+	}
+
+	const auto error = co_await with_deadline(m_timeouts.send, [&]() -> awaitable<boost::system::error_code>
+	{
+		boost::system::error_code write_error;
+		co_await asio::async_write(
+			m_socket,
+			asio::buffer(frame->data(), frame->size()),
+			asio::redirect_error(asio::use_awaitable, write_error)
+		);
+		co_return write_error;
+	});
+
+	if (error)
+	{
+		co_return std::unexpected{ error };
+	}
+
+	co_return sequence_number;
+}
+
+template<class P, class F>
+boost::asio::awaitable<std::error_code> deye::async_connector::receive_modbus_frame(P&& is_awaited, F&& read_request)
+{
+	namespace asio = boost::asio;
+	auto message = std::span<std::uint8_t>{};
+
+	// Late responses to earlier failed requests are dropped.
+	while (message.empty() or not is_awaited(detail::modbus::header_sequence_number(message)))
+	{
+		const auto frame = m_decoder.next(m_serial_number);
+		if (not frame)
+		{
+			co_return frame.error();
+		}
+
+		message = *frame;
+
+		if (message.empty())
+		{
+			const auto free_space = m_decoder.prepare();
+
+			auto received = std::size_t{};
+
+			const auto error = co_await with_deadline(m_timeouts.receive, [&]() -> awaitable<boost::system::error_code>
+			{
+				boost::system::error_code read_error;
+				received = co_await m_socket.async_read_some(
+					asio::buffer(free_space.data(), free_space.size()),
+					asio::redirect_error(asio::use_awaitable, read_error)
+				);
+				co_return read_error;
+			});
+
+			if (error)
+			{
+				co_return error;
+			}
+
+			m_decoder.commit(received);
+		}
+	}
+
+	const auto sequence_number = detail::modbus::header_sequence_number(message);
+
+	co_return detail::modbus::decode_frame(message, [&](std::span<std::uint8_t> response)
+	{
+		return read_request(sequence_number, response);
+	});
+}
+
+template<class F>
+boost::asio::awaitable<std::error_code> deye::async_connector::with_deadline(
+	const std::chrono::milliseconds timeout,
+	F&& operation
+) {
+	using clock = boost::asio::steady_timer::clock_type;
+
+	if (timeout.count() > 0)
+	{
+		m_deadline.expires_after(timeout);
+		m_deadline.async_wait([this](const boost::system::error_code& error)
+		{
+			// Also queued when the operation completed in the same run, the deadline is moved to the end of time then.
+			if (not error and m_deadline.expiry() <= clock::now())
+			{
+				boost::system::error_code cancel_error;
+				m_socket.cancel(cancel_error);
+			}
+		});
+	}
+
+	const auto error = co_await operation();
+
+	const auto expired = timeout.count() > 0 and m_deadline.expiry() <= clock::now();
+	m_deadline.expires_at(clock::time_point::max());
+
+	if (expired and error == boost::asio::error::operation_aborted)
+	{
+		co_return connector_error::make_error_code(connector_error::codes::operation_timed_out);
+	}
+
+	co_return error;
+}
@@ -15,53 +15,129 @@ using tcp = asio::ip::tcp;
 asio_tcp_socket::asio_tcp_socket() :
 	ctx{ }, socket{ ctx } {};
 
+// Runs one asynchronous operation on the private io_context and cancels it once the timeout expires.
+template<class F>
+std::error_code asio_tcp_socket::run_with_timeout(const std::chrono::milliseconds timeout, F&& initiate) {
+	boost::system::error_code error;
+	bool done = false;
+
+	initiate([&](const boost::system::error_code& result, auto&&...) {
+		error = result;
+		done = true;
+	});
+
+	ctx.restart();
+
+	if (timeout.count() > 0) {
+		ctx.run_for(timeout);
+	} else {
+		ctx.run();
+	}
+
+	if (not done) {
+		// Let the canceled operation complete before returning, as it references the callers buffer.
+		boost::system::error_code cancel_error;
+		socket.cancel(cancel_error);
+		ctx.restart();
+		ctx.run();
+		return std::make_error_code(std::errc::timed_out);
+	}
+
+	return error;
+}
+
 std::error_code asio_tcp_socket::connect(const char* host, const uint16_t port) {
-	using namespace std::chrono_literals;
 	boost::system::error_code error;
 
-	if (not ctx.stopped() and socket.is_open() and (error = disconnect())) {
-		return error;
+	if (socket.is_open()) {
+		if (const auto disconnect_error = disconnect()) return disconnect_error;
 	}
 
 	const auto ip = asio::ip::make_address(host, error);
 	if (error) return error;
 
-	ctx.restart();
-	socket.connect(tcp::endpoint(ip, port), error);
-	
+	const auto connect_error = run_with_timeout(connect_timeout, [&](auto&& handler) {
+		socket.async_connect(tcp::endpoint(ip, port), std::move(handler));
+	});
+
+	if (connect_error) {
+		if (socket.is_open()) socket.close(error);
+		return connect_error;
+	}
+
+	// Pipelined frames must not wait for the acknowledgement of the previous one.
+	socket.set_option(tcp::no_delay(true), error);
+
 	return error;
 }
 
 std::error_code asio_tcp_socket::listen(const uint16_t port) {
 	boost::system::error_code error;
 
-	if (not ctx.stopped() and (error = disconnect())) {
-		return error;
+	if (socket.is_open()) {
+		if (const auto disconnect_error = disconnect()) return disconnect_error;
 	}
 
 	const auto endpoint = tcp::endpoint(tcp::v4(), port);
-	return tcp::acceptor(ctx, endpoint).accept(socket, error);
+	if (tcp::acceptor(ctx, endpoint).accept(socket, error)) return error;
+
+	socket.set_option(tcp::no_delay(true), error);
+
+	return error;
 }
 
 std::error_code asio_tcp_socket::send(std::span<const uint8_t> data) {
-	boost::system::error_code error;
-	asio::write(socket, asio::const_buffer{ data.data(), data.size() }, error);
-	return error;
+	return run_with_timeout(send_timeout, [&](auto&& handler) {
+		asio::async_write(socket, asio::const_buffer{ data.data(), data.size() }, std::move(handler));
+	});
 }
 
 std::error_code asio_tcp_socket::receive(std::span<uint8_t> data) {
-	boost::system::error_code error;
-	asio::read(socket, asio::mutable_buffer{ data.data(), data.size() }, error);
-	return error;
+	return run_with_timeout(receive_timeout, [&](auto&& handler) {
+		asio::async_read(socket, asio::mutable_buffer{ data.data(), data.size() }, std::move(handler));
+	});
+}
+
+std::expected<std::size_t, std::error_code> asio_tcp_socket::receive_some(std::span<uint8_t> data) {
+	std::size_t received = 0;
+
+	const auto error = run_with_timeout(receive_timeout, [&](auto&& handler) {
+		socket.async_read_some(
+			asio::mutable_buffer{ data.data(), data.size() },
+			[&, handler = std::move(handler)](const boost::system::error_code& result, const std::size_t size) mutable {
+				received = size;
+				handler(result);
+			}
+		);
+	});
+
+	if (error) return std::unexpected{ error };
+
+	return received;
 }
 
 std::error_code asio_tcp_socket::disconnect() {
 	boost::system::error_code error;
 	socket.shutdown(asio::ip::tcp::socket::shutdown_both, error);
-	if (error) return error;
-	socket.close();
+
+	// A peer that already went away (e.g. after a timeout) must not keep the socket open.
+	if (error == asio::error::not_connected) error = {};
+
+	boost::system::error_code close_error;
+	socket.close(close_error);
 	ctx.stop();
-	return error;
+
+	return error ? error : close_error;
+}
+
+void asio_tcp_socket::set_timeouts(
+	const std::chrono::milliseconds connect,
+	const std::chrono::milliseconds send,
+	const std::chrono::milliseconds receive
+) {
+	connect_timeout = connect;
+	send_timeout = send;
+	receive_timeout = receive;
 }
 
 asio_tcp_socket::~asio_tcp_socket() {
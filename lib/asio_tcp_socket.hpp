@@ -10,6 +10,8 @@
 #include <system_error>
 #include <cstdint>
 #include <span>
+#include <chrono>
+#include <expected>
 
 #include <boost/asio.hpp>
 #include <boost/asio/ip/tcp.hpp>
@@ -26,12 +28,24 @@ public:
 	[[nodiscard]] std::error_code send(std::span<const uint8_t> data);
 	
 	[[nodiscard]] std::error_code receive(std::span<uint8_t> data);
+
+	[[nodiscard]] std::expected<std::size_t, std::error_code> receive_some(std::span<uint8_t> data);
 	
 	[[nodiscard]] std::error_code disconnect();
 
+	void set_timeouts(
+		std::chrono::milliseconds connect_timeout,
+		std::chrono::milliseconds send_timeout,
+		std::chrono::milliseconds receive_timeout
+	);
+
 	~asio_tcp_socket();
 
 private:
+	template<class F>
+	[[nodiscard]] std::error_code run_with_timeout(std::chrono::milliseconds timeout, F&& initiate);
+
 	boost::asio::io_context ctx;
 	boost::asio::ip::tcp::socket socket;
+	std::chrono::milliseconds connect_timeout{}, send_timeout{}, receive_timeout{};
 };
@@ -0,0 +1,201 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <vector>
+
+namespace deye
+{
+
+/**
+ * @brief Holds the raw register values that don't fit into a `compact_sensor_value`.
+ *
+ * Values only reference their registers by index, so a store is shared by all values of a buffer
+ * and has to outlive them. Clearing the store invalidates all values that reference it.
+ */
+class compact_register_store
+{
+public:
+	[[nodiscard]] std::uint32_t push(const sensor_value::registers& registers);
+
+	[[nodiscard]] const sensor_value::registers& operator[](std::uint32_t index) const;
+
+	[[nodiscard]] std::size_t size() const;
+
+	void reserve(std::size_t size);
+
+	void clear();
+
+private:
+	std::vector<sensor_value::registers> m_registers;
+};
+
+/**
+ * @brief Lossless 16 byte encoding of a `sensor_value` for buffering large amounts of samples.
+ *
+ * The payload holds the double, integer or enumeration index, the unit or enumeration id is stored next to it.
+ * Raw registers are kept inline if only the first four are used and in a `compact_register_store` otherwise.
+ */
+class compact_sensor_value
+{
+public:
+	constexpr compact_sensor_value() = default;
+
+	/**
+	 * @param store Receives the registers of register values that don't fit inline.
+	 */
+	[[nodiscard]] static compact_sensor_value encode(const sensor_value& value, compact_register_store& store);
+
+	/**
+	 * @param store The store given to `encode`.
+	 */
+	[[nodiscard]] sensor_value decode(const compact_register_store& store) const;
+
+	[[nodiscard]] constexpr sensor_value_rep_id type() const;
+
+private:
+	static constexpr std::size_t inline_register_count = sizeof(std::uint64_t) / sizeof(std::uint16_t);
+
+	// Physical value, integer value, enumeration index, inline registers or index into the store.
+	union
+	{
+		double m_physical;
+		std::int64_t m_integer;
+		std::uint64_t m_index{};
+		std::array<std::uint16_t, inline_register_count> m_registers;
+	};
+
+	// Physical unit or enumeration id.
+	std::uint16_t m_id{};
+
+	sensor_value_rep_id m_type{ sensor_value_rep_id::empty };
+
+	bool m_out_of_line{ false };
+};
+
+static_assert(sizeof(compact_sensor_value) == 16);
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+inline std::uint32_t deye::compact_register_store::push(const sensor_value::registers& registers)
+{
+	const auto index = static_cast<std::uint32_t>(m_registers.size());
+	m_registers.push_back(registers);
+	return index;
+}
+
+inline const deye::sensor_value::registers& deye::compact_register_store::operator[](const std::uint32_t index) const
+{
+	return m_registers[index];
+}
+
+inline std::size_t deye::compact_register_store::size() const
+{
+	return m_registers.size();
+}
+
+inline void deye::compact_register_store::reserve(const std::size_t size)
+{
+	m_registers.reserve(size);
+}
+
+inline void deye::compact_register_store::clear()
+{
+	m_registers.clear();
+}
+
+inline deye::compact_sensor_value deye::compact_sensor_value::encode(
+	const sensor_value& value,
+	compact_register_store& store
+) {
+	auto compact = compact_sensor_value{};
+	compact.m_type = value.type();
+
+	value.visit(
+		[&](const sensor_value::registers& registers)
+		{
+			const auto used = std::ranges::find_if(
+				registers.data.rbegin(), registers.data.rend(),
+				[](const std::uint16_t reg) { return reg != 0; }
+			);
+			const auto used_count = static_cast<std::size_t>(registers.data.rend() - used);
+
+			if (used_count <= inline_register_count)
+			{
+				compact.m_registers = {};
+				std::copy_n(registers.data.begin(), inline_register_count, compact.m_registers.begin());
+			}
+			else
+			{
+				compact.m_index = store.push(registers);
+				compact.m_out_of_line = true;
+			}
+		},
+		[&](const sensor_value::integer& integer)
+		{
+			compact.m_integer = integer.value;
+		},
+		[&](const sensor_value::physical& physical)
+		{
+			compact.m_physical = physical.value;
+			compact.m_id = static_cast<std::uint16_t>(physical.unit_id);
+		},
+		[&](const sensor_value::enumeration& enumeration)
+		{
+			compact.m_index = enumeration.index;
+			compact.m_id = static_cast<std::uint16_t>(enumeration.enum_id);
+		},
+		[&](const sensor_value::empty&) {}
+	);
+
+	return compact;
+}
+
+inline deye::sensor_value deye::compact_sensor_value::decode(const compact_register_store& store) const
+{
+	switch (m_type)
+	{
+	case sensor_value_rep_id::registers:
+	{
+		if (m_out_of_line)
+		{
+			return { store[static_cast<std::uint32_t>(m_index)] };
+		}
+		auto registers = sensor_value::registers{};
+		std::ranges::copy(m_registers, registers.data.begin());
+		return { registers };
+	}
+	case sensor_value_rep_id::integer:
+		return { sensor_value::integer{ .value = m_integer } };
+	case sensor_value_rep_id::physical:
+		return {
+			sensor_value::physical{
+				.value = m_physical,
+				.unit_id = static_cast<config::physical_unit_id>(m_id)
+			}
+		};
+	case sensor_value_rep_id::enumeration:
+		return {
+			sensor_value::enumeration{
+				.index = static_cast<std::size_t>(m_index),
+				.enum_id = static_cast<config::enumeration_id>(m_id)
+			}
+		};
+	default:
+		return {};
+	}
+}
+
+constexpr deye::sensor_value_rep_id deye::compact_sensor_value::type() const
+{
+	return m_type;
+}
@@ -15,6 +15,10 @@
 #include <variant>
 #include <ranges>
 #include <cstring>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <bitset>
 
 #include <algorithm>
 #include <numeric>
@@ -121,6 +125,41 @@ concept disconnect = requires(T socket)
 	{ socket.disconnect() } -> std::same_as<std::error_code>;
 };
 
+template<class T>
+concept set_timeouts = requires(
+	T socket,
+	std::chrono::milliseconds connect_timeout,
+	std::chrono::milliseconds send_timeout,
+	std::chrono::milliseconds receive_timeout
+) {
+	/**
+	 * @brief Sets the deadlines of all following `connect`, `send` and `receive` calls.
+	 * An operation that does not complete within its deadline fails with `std::errc::timed_out`,
+	 * a deadline of zero waits forever.
+	 *
+	 * @param connect_timeout The deadline of a complete `connect` call.
+	 * @param send_timeout The deadline of a complete `send` call, not of the individual system calls.
+	 * @param receive_timeout The deadline of a complete `receive` call, not of the individual system calls.
+	 */
+	{ socket.set_timeouts(connect_timeout, send_timeout, receive_timeout) } -> std::same_as<void>;
+};
+
+/**
+ * Optional, sockets that implement it let the connector read whole bursts of frames at once.
+ */
+template<class T>
+concept receive_some = requires(T socket, std::span<std::uint8_t> data)
+{
+	/**
+	 * @brief Receives data from a connected socket, blocking until at least one byte is received.
+	 *
+	 * @param buffer The buffer to store the received data in, may be filled partially.
+	 *
+	 * @return The number of received bytes or an `std::error_code` on failure, a closed connection is an error.
+	 */
+	{ socket.receive_some(data) } -> std::same_as<std::expected<std::size_t, std::error_code>>;
+};
+
 } // tcp_socket_concepts
 
 template<class T>
@@ -129,7 +168,8 @@ concept tcp_socket = (
 	tcp_socket_concepts::connect<T> and
 	tcp_socket_concepts::send<T> and
 	tcp_socket_concepts::receive<T> and
-	tcp_socket_concepts::disconnect<T>
+	tcp_socket_concepts::disconnect<T> and
+	tcp_socket_concepts::set_timeouts<T>
 );
 
 namespace modbus
@@ -139,6 +179,36 @@ namespace modbus
 
 [[nodiscard]] inline constexpr std::uint16_t crc(std::span<const std::uint8_t> data);
 
+// Continues a `crc` over more data, `crc(a + b) == crc_update(crc(a), b)`.
+[[nodiscard]] inline constexpr std::uint16_t crc_update(std::uint16_t crc, std::span<const std::uint8_t> data);
+
+// Bit at a time reference implementation of `crc`.
+[[nodiscard]] inline constexpr std::uint16_t crc_bitwise(std::span<const std::uint8_t> data);
+
+// start byte, payload length, control code, inverter serial number prefix and serial number
+inline constexpr std::size_t header_size = 11;
+
+// checksum and end byte
+inline constexpr std::size_t trailer_size = 2;
+
+inline constexpr std::size_t request_data_field_size = 15;
+inline constexpr std::size_t response_data_field_size = 14;
+
+// request type, begin address and register count
+inline constexpr std::size_t read_request_size = 6;
+
+// request type, begin address, register count and byte count, followed by the registers
+inline constexpr std::size_t write_request_header_size = 7;
+
+// Modbus limits a single write to 123 registers.
+inline constexpr std::size_t max_write_register_count = 123;
+
+[[nodiscard]] inline constexpr std::size_t write_request_size(std::size_t register_count);
+
+[[nodiscard]] inline constexpr std::size_t request_frame_size(std::size_t request_size);
+
+[[nodiscard]] inline constexpr std::size_t read_response_frame_size(std::size_t register_count);
+
 } // namespace modbus
 
 namespace bytes
@@ -267,13 +337,22 @@ struct sensor_value_rep
 	constexpr sensor_value_rep(physical rep);
 	constexpr sensor_value_rep(enumeration rep);
 
-	[[nodiscard]] sensor_value_rep_id type() const;
+	[[nodiscard]] constexpr sensor_value_rep_id type() const;
 
 	template<class T>
-	[[nodiscard]] std::optional<T> get() const;
+	[[nodiscard]] constexpr std::optional<T> get() const;
 
 	[[nodiscard]] std::expected<sensor_value, std::error_code> interpret(std::span<const std::uint16_t> registers) const;
 
+	/**
+	 * @brief The inverse of `interpret`, converts a value back to the raw registers of its sensor.
+	 *
+	 * Physical values are rounded to the nearest raw value, integer values have to be exact.
+	 *
+	 * @param registers Receives the raw registers, its size is the register count of the sensor.
+	 */
+	[[nodiscard]] std::error_code encode(const sensor_value& value, std::span<std::uint16_t> registers) const;
+
 private:
 	std::variant<
 		registers,
@@ -304,432 +383,2364 @@ struct enumeration
 [[nodiscard]] constexpr std::optional<physical_unit> physical_unit_by_id(config::physical_unit_id id);
 [[nodiscard]] constexpr std::optional<enumeration> enumeration_by_id(config::enumeration_id id);
 
+// The largest sensor table the connector plans with, it bounds the planners stack buffers.
+inline constexpr std::size_t max_sensor_table_size = 256;
 
-template<detail::tcp_socket Socket>
-class connector
+struct register_range
 {
-public:
-	connector(serial_number_type serial_number);
+	std::uint16_t begin_address, register_count;
+};
 
-	[[nodiscard]] std::error_code connect(const char* host, std::uint16_t port);
+struct read_plan_config
+{
+	// The maximum number of registers requested in one frame.
+	// Modbus limits a single read to 125 registers, some loggers return less.
+	std::uint16_t max_registers_per_frame{ 125 };
+
+	// The cost of an additional round trip measured in registers.
+	// Gaps of unused registers up to this size are read instead of being split into a new frame.
+	// The default matches the frame overhead of one read (36 byte request + 32 byte response).
+	std::uint16_t round_trip_cost{ 34 };
+
+	// The number of read requests sent before waiting for the first response.
+	// Responses are matched to their request by sequence number, a value of one disables pipelining.
+	// Loggers that drop requests under load leave their responses missing, so pipelining is opt in.
+	std::uint8_t max_frames_in_flight{ 1 };
+};
 
-	[[nodiscard]] std::expected<sensor_value, std::error_code> read_sensor(config::sensor_id id);
+struct timeout_config
+{
+	// A value of zero disables the timeout.
+	std::chrono::milliseconds connect{ 5'000 };
+	std::chrono::milliseconds send{ 5'000 };
+	std::chrono::milliseconds receive{ 5'000 };
+};
 
-	[[nodiscard]] std::error_code read_sensors(std::span<const config::sensor_id> sensor_ids, std::span<sensor_value> values);
+/**
+ * @brief Structure of arrays output of the batch decode, one element per requested sensor.
+ *
+ * Physical and integer sensors hold their scaled value, enumeration sensors their index
+ * and register sensors NaN. Sensors without a physical unit are marked with `config::physical_unit_id::COUNT`.
+ */
+struct sensor_columns
+{
+	std::span<double> values;
+	std::span<config::physical_unit_id> unit_ids;
+};
 
-	[[nodiscard]] std::error_code disconnect();
+namespace detail::read_planner
+{
 
-	[[nodiscard]] serial_number_type& serial_number();
-	[[nodiscard]] const serial_number_type& serial_number() const;
+/**
+ * @brief Splits the requested sensors into the register ranges that minimize the sum of
+ * wasted registers and round trip costs while respecting the per frame register limit.
+ *
+ * @param sensors The sensor table, has to be sorted by `begin_address`.
+ * @param is_requested Predicate that is called with the index of every sensor in `sensors`.
+ * @param config The cost model and frame limit to plan with.
+ * @param on_range Called with every planned range in ascending order, returning an error stops the planning.
+ *
+ * @note A single sensor that exceeds `max_registers_per_frame` is still planned as one range.
+ *
+ * @return The first error returned by `on_range` or a value initialized error if all ranges succeeded.
+ */
+template<class P, class F>
+[[nodiscard]] constexpr auto for_each_range(
+	std::span<const sensor_meta> sensors,
+	P&& is_requested,
+	const read_plan_config& config,
+	F&& on_range
+) -> std::invoke_result_t<F&, const register_range&>;
+
+/**
+ * @brief The read plan of a fixed set of sensors, computed at compile time.
+ *
+ * Holds the planned register ranges and for every sensor the range it is read in
+ * and its offset into that range's registers.
+ */
+template<auto SensorIds, read_plan_config Config>
+struct static_plan;
 
-protected:
-	[[nodiscard]] std::expected<std::span<std::uint16_t>, std::error_code> read_registers(std::uint16_t begin_address, std::uint16_t register_count);
+} // namespace detail::read_planner
 
-	[[nodiscard]] std::error_code write_registers(std::uint16_t begin_address, std::span<const std::uint16_t> values);
+namespace detail::columns
+{
 
-	template<class F, class G>
-	[[nodiscard]] std::error_code modbus_request(std::size_t data_size, F&& write_request, G&& read_request);
+/**
+ * @brief The linear map from a sensors raw integer value to its column value.
+ */
+struct transform
+{
+	double scale, offset;
+	config::physical_unit_id unit_id;
+};
 
-	template<class F>
-	[[nodiscard]] std::error_code send_modbus_frame(std::size_t data_size, F&& write_request);
+[[nodiscard]] constexpr transform transform_of(const sensor_value_rep& rep);
 
-	template<class F>
-	[[nodiscard]] std::error_code receive_modbus_frame(F&& read_request);
+/**
+ * @brief Stores the raw integer value of every sensor of `sensor_ids` that lies completely within `range`.
+ *
+ * @param registers The registers read for `range`.
+ */
+[[nodiscard]] inline std::error_code gather_range(
+	std::span<const sensor_meta> sensors,
+	std::span<const config::sensor_id> sensor_ids,
+	std::span<double> raw_values,
+	const register_range& range,
+	std::span<const std::uint16_t> registers
+);
 
-private:
-	Socket m_socket{};
-	std::array<std::uint8_t, 2048> m_buffer{};
-	serial_number_type m_serial_number{};
-};
-} // namespace deye
+/**
+ * @brief Computes `values[i] * scales[i] + offsets[i]` in place, vectorized where the compiler supports it.
+ */
+inline void scale_and_offset(std::span<double> values, std::span<const double> scales, std::span<const double> offsets);
 
+} // namespace detail::columns
 
-//====================[ implementations ]====================//
+namespace detail::modbus
+{
 
-constexpr deye::sensor_value_rep::sensor_value_rep(registers rep) : m_data{ std::move(rep) } {}
-constexpr deye::sensor_value_rep::sensor_value_rep(integer rep) : m_data{ std::move(rep) } {}
-constexpr deye::sensor_value_rep::sensor_value_rep(physical rep) : m_data{ std::move(rep) } {}
-constexpr deye::sensor_value_rep::sensor_value_rep(enumeration rep) : m_data{ std::move(rep) } {}
+/**
+ * @brief Encodes a complete request frame into `buffer`.
+ *
+ * @param write_request Called with the `data_size` bytes of the modbus request to fill in.
+ *
+ * @return The encoded frame, a prefix of `buffer`.
+ */
+template<class F>
+[[nodiscard]] std::expected<std::span<std::uint8_t>, std::error_code> encode_frame(
+	std::span<std::uint8_t> buffer,
+	serial_number_type serial_number,
+	std::uint8_t sequence_number,
+	std::size_t data_size,
+	F&& write_request
+);
 
-inline deye::sensor_value_rep_id deye::sensor_value_rep::type() const
-{
-	// To match up with the id enum the "empty" value of `sensor_value` is skipped.
-	return static_cast<sensor_value_rep_id>(m_data.index() + 1);
-}
+/**
+ * @brief Validates the framing of the first `header_size` bytes of a response frame.
+ *
+ * @return The size of the complete frame including the header.
+ */
+[[nodiscard]] inline std::expected<std::size_t, std::error_code> check_header(std::span<const std::uint8_t> header);
 
-template<class T>
-inline std::optional<T> deye::sensor_value_rep::get() const
-{
-	if (const auto ptr = std::get_if<T>(&m_data); ptr != nullptr)
-	{
-		return *ptr;
-	}
-	return std::nullopt;
-}
+/**
+ * @brief Checks that a response header was sent by the logger with `serial_number`.
+ */
+[[nodiscard]] inline std::error_code check_serial_number(
+	std::span<const std::uint8_t> header,
+	serial_number_type serial_number
+);
 
-inline std::expected<deye::sensor_value, std::error_code> deye::sensor_value_rep::interpret(
-	std::span<const std::uint16_t> raw_registers
-) const {
-	auto integer_value = std::uint64_t{};
+/**
+ * @brief Returns the sequence number of the request a response header answers.
+ */
+[[nodiscard]] inline std::uint8_t header_sequence_number(std::span<const std::uint8_t> header);
 
-	if (type() == sensor_value_rep_id::registers)
-	{
-		if (raw_registers.size() > registers::max_size)
-		{
-			return std::unexpected{ std::make_error_code(std::errc::result_out_of_range) };
-		}
-	}
-	else
-	{
-		if (raw_registers.size_bytes() > sizeof(integer_value))
-		{
-			return std::unexpected{ std::make_error_code(std::errc::result_out_of_range) };
-		}
-		std::memcpy(&integer_value, raw_registers.data(), std::min(sizeof(integer_value), raw_registers.size()));
-	}
+/**
+ * @brief Calls `read_request` with the modbus response of a frame validated by a `frame_decoder`.
+ */
+template<class F>
+[[nodiscard]] std::error_code decode_frame(std::span<std::uint8_t> message, F&& read_request);
 
-	return std::visit(
-		detail::overloaded_lambda{
-			[&](const registers&) -> sensor_value
-			{
-				auto value = sensor_value::registers{};
-				std::ranges::copy(raw_registers, value.data.begin());
-				return { value };
-			},
-			[&](const integer& rep) -> sensor_value
-			{
-				auto value = static_cast<std::int64_t>(integer_value);
-				value *= rep.scale;
-				value += rep.offset;
-				return {
-					sensor_value::integer{
-						.value = value
-					}
-				};
-			},
-			[&](const physical& rep) -> sensor_value
-			{
-				auto value = static_cast<double>(integer_value);
-				value *= rep.scale;
-				value += rep.offset;
-				return {
-					sensor_value::physical{
-						.value = value,
-						.unit_id = rep.unit_id
-					}
-				};
-			},
-			[&](const enumeration& rep) -> sensor_value
-			{
-				const auto index = integer_value;
-				return {
-					sensor_value::enumeration{
-						.index = index,
-						.enum_id = rep.enum_id
-					}
-				};
-			},
-		},
-		m_data
-	);
-}
+[[nodiscard]] inline std::error_code encode_read_request(
+	std::span<std::uint8_t> request,
+	std::uint16_t begin_address,
+	std::uint16_t register_count
+);
 
-constexpr deye::sensor_value::sensor_value() : m_data{ empty{} } {}
-constexpr deye::sensor_value::sensor_value(registers value) : m_data{ std::move(value) } {}
-constexpr deye::sensor_value::sensor_value(integer value) : m_data{ std::move(value) } {}
-constexpr deye::sensor_value::sensor_value(enumeration value) : m_data{ std::move(value) } {}
-constexpr deye::sensor_value::sensor_value(physical value) : m_data{ std::move(value) } {}
+/**
+ * @brief Checks the register count of a read response and converts its registers to native byte order in place.
+ *
+ * The crc is expected to be validated by the `frame_decoder` already.
+ */
+[[nodiscard]] inline std::expected<std::span<std::uint16_t>, std::error_code> decode_read_response(
+	std::span<std::uint8_t> response,
+	std::uint16_t register_count
+);
 
-deye::sensor_value_rep_id deye::sensor_value::type() const
-{
-	return static_cast<sensor_value_rep_id>(m_data.index());
-}
+/**
+ * @brief Converts big endian registers to native byte order in place, vectorized where the compiler supports it.
+ */
+inline void byteswap_registers(std::span<std::uint16_t> registers);
 
-template<class T>
-std::optional<T> deye::sensor_value::get() const
-{
-	if (const auto ptr = std::get_if<T>(&m_data); ptr != nullptr)
-	{
-		return *ptr;
-	}
-	return std::nullopt;
-}
+[[nodiscard]] inline std::error_code encode_write_request(
+	std::span<std::uint8_t> request,
+	std::uint16_t begin_address,
+	std::span<const std::uint16_t> values
+);
 
-template<class... F>
-auto deye::sensor_value::visit(F&&... visitors)
-{
-	return std::visit(
-		detail::overloaded_lambda{
-			std::forward<F>(visitors)...
-		},
-		m_data
-	);
-}
+/**
+ * @brief Checks that a write response echoes the address and register count of its request.
+ */
+[[nodiscard]] inline std::error_code decode_write_response(
+	std::span<const std::uint8_t> response,
+	std::uint16_t begin_address,
+	std::size_t register_count
+);
 
-template<class... F>
-auto deye::sensor_value::visit(F&&... visitors) const
+/**
+ * @brief The constant start of the request frames to one logger, encoded once together with its checksum.
+ *
+ * Start byte, control code, serial number and data field are the same for every request,
+ * so encoding a frame only patches the payload size, sequence number, modbus request, crc and checksum.
+ */
+class frame_template
 {
-	return std::visit(
-		detail::overloaded_lambda{
-			std::forward<F>(visitors)...
-		},
-		m_data
-	);
-}
+public:
+	explicit frame_template(serial_number_type serial_number = 0);
 
-#include "deye_config.hpp"
+	[[nodiscard]] serial_number_type serial_number() const;
+
+	/**
+	 * @brief Encodes a complete request frame into `buffer`, same as `encode_frame`.
+	 */
+	template<class F>
+	[[nodiscard]] std::expected<std::span<std::uint8_t>, std::error_code> encode(
+		std::span<std::uint8_t> buffer,
+		std::uint8_t sequence_number,
+		std::size_t data_size,
+		F&& write_request
+	) const;
 
+	/**
+	 * @brief Replaces the sequence number of an encoded request frame and patches its checksum accordingly.
+	 */
+	static void set_sequence_number(std::span<std::uint8_t> frame, std::uint8_t sequence_number);
 
-//--------------[ connector implementation ]--------------//
+	// start byte, payload length, control code, sequence number, serial number and data field
+	static constexpr std::size_t prefix_size = header_size + request_data_field_size;
 
-namespace deye::connector_error
-{
-enum class codes
-{
-	ok = 0,
-	action_exceeds_local_buffer_size,
-	too_many_register_values,
-	serial_number_mismatch,
-	device_address_mismatch,
-	unknown_response_code,
-	response_invalid_start,
-	response_invalid_end,
-	response_wrong_checksum,
-	response_wrong_crc,
-	response_wrong_address,
-	response_wrong_register_count,
-	num_sensors_values_mismatch,
-	unknown_sensor,
-	unknown_unit,
-	internal_error
+private:
+	static constexpr std::size_t payload_size_offset = 1;
+	static constexpr std::size_t sequence_number_offset = 5;
+
+	// The prefix with payload size and sequence number left zero, so they don't contribute to its checksum.
+	std::array<std::uint8_t, prefix_size> m_prefix{};
+	std::uint8_t m_prefix_checksum{};
+	serial_number_type m_serial_number{};
 };
 
-struct category : std::error_category
+} // namespace detail::modbus
+
+/**
+ * @brief Resumable decoder that cuts a received byte stream into validated response frames.
+ *
+ * Bytes may arrive in chunks of any size. Start byte and header are checked as soon as they are complete,
+ * checksum and crc are accumulated over every chunk as it arrives, so no byte is visited twice.
+ * Transports receive directly into the decoders buffer (`prepare`/`commit`) or copy into it (`feed`),
+ * complete frames are handed out as spans into that buffer without copying.
+ * The decoder never blocks, so blocking sockets, event loops and completion based io can share it.
+ */
+template<std::size_t Capacity>
+class frame_decoder
+{
+public:
+	/**
+	 * @brief Returns the free space at the end of the buffer to receive into.
+	 *
+	 * Invalidates the frame returned by the last `next` call.
+	 */
+	[[nodiscard]] std::span<std::uint8_t> prepare();
+
+	/**
+	 * @brief Marks `size` bytes written to the front of the span returned by `prepare` as received.
+	 */
+	void commit(std::size_t size);
+
+	/**
+	 * @brief Copies as many of `bytes` into the buffer as fit.
+	 *
+	 * @return The number of bytes consumed, the remaining bytes have to be fed again after calling `next`.
+	 */
+	std::size_t feed(std::span<const std::uint8_t> bytes);
+
+	/**
+	 * @brief Advances the decoder over the received bytes.
+	 *
+	 * @return The next complete and validated frame, an empty span if more bytes are needed or an error.
+	 * The frame may be modified in place and stays valid until the next call to any non const member.
+	 * A complete frame that fails validation is consumed like a valid one, the frames behind it stay buffered.
+	 * After a framing error the stream is out of sync and all buffered bytes are dropped.
+	 */
+	[[nodiscard]] std::expected<std::span<std::uint8_t>, std::error_code> next(serial_number_type serial_number);
+
+	/**
+	 * @brief The complete frame the last `next` call consumed and reported an error for, valid until the next `prepare`.
+	 *
+	 * Empty if the call succeeded or failed on the framing, so callers can still match the frame to its request.
+	 */
+	[[nodiscard]] std::span<const std::uint8_t> rejected_frame() const;
+
+	/**
+	 * @brief The number of bytes that complete the current header or frame, for transports that read exact sizes.
+	 */
+	[[nodiscard]] std::size_t bytes_needed() const;
+
+	/**
+	 * @brief Drops all buffered bytes, needed whenever the stream is out of sync or reconnected.
+	 */
+	void reset();
+
+private:
+	enum class state : std::uint8_t
+	{
+		header,
+		body,
+		trailer
+	};
+
+	void discard_returned_frame();
+
+	std::array<std::uint8_t, Capacity> m_buffer{};
+
+	// [m_begin, m_end) are the received bytes, m_parsed counts the bytes of the current frame folded into the checks.
+	std::size_t m_begin{}, m_end{}, m_parsed{}, m_frame_size{}, m_returned_size{};
+
+	state m_state{ state::header };
+	std::uint8_t m_checksum{};
+	std::uint16_t m_crc{};
+
+	// Found in the header but only reported once the frame is complete, so the frame can be skipped.
+	std::error_code m_frame_error{};
+	bool m_rejected{ false };
+};
+
+namespace detail
+{
+
+/**
+ * @brief Blocking adapter that drives a `frame_decoder` from a socket.
+ *
+ * Sockets that implement `receive_some` are drained in chunks as large as the buffer allows,
+ * so a burst of pipelined responses costs a single system call instead of two per frame.
+ * Other sockets are read with exact sized `receive` calls.
+ */
+template<std::size_t Capacity>
+class frame_reader
+{
+public:
+	/**
+	 * @brief Receives the next validated frame.
+	 *
+	 * @return The complete frame, it may be modified in place and stays valid until the next call.
+	 */
+	template<tcp_socket Socket>
+	[[nodiscard]] std::expected<std::span<std::uint8_t>, std::error_code> next_frame(
+		Socket& socket,
+		serial_number_type serial_number
+	);
+
+	// See `frame_decoder::rejected_frame`.
+	[[nodiscard]] std::span<const std::uint8_t> rejected_frame() const;
+
+	/**
+	 * @brief Whether the last `next_frame` call stopped at a frame boundary, which framing and socket errors don't.
+	 */
+	[[nodiscard]] bool in_sync() const;
+
+	/**
+	 * @brief Drops all buffered bytes, needed whenever the stream is out of sync or reconnected.
+	 */
+	void clear();
+
+private:
+	frame_decoder<Capacity> m_decoder{};
+	bool m_in_sync{ true };
+};
+
+/**
+ * @brief Raw values of the `size` registers from `begin_address` together with the time they were read.
+ *
+ * Every address has its own slot, so a planned range never evicts registers of another range.
+ */
+struct register_cache
+{
+	using clock = std::chrono::steady_clock;
+
+	// Covers the address space of `config::sensors`, addresses outside are always read from the logger.
+	static constexpr std::size_t size = 256;
+
+	inline register_cache();
+
+	[[nodiscard]] constexpr bool covers(const register_range& range) const;
+
+	/**
+	 * @return Whether the register was read at or after `expired_before`.
+	 */
+	[[nodiscard]] inline bool fresh(std::size_t address, clock::time_point expired_before) const;
+
+	inline void store(std::uint16_t begin_address, std::span<const std::uint16_t> registers, clock::time_point read_time);
+
+	// The cached values of a covered range, they stay valid until the next `store`.
+	[[nodiscard]] inline std::span<std::uint16_t> view(const register_range& range);
+
+	inline void invalidate(std::uint16_t begin_address, std::size_t register_count);
+
+	inline void clear();
+
+	// Moves the covered addresses to start at `address` and drops all values.
+	inline void rebase(std::uint16_t address);
+
+	std::uint16_t begin_address{};
+	std::array<std::uint16_t, size> values{};
+	std::array<clock::time_point, size> read_times{};
+};
+
+} // namespace detail
+
+
+template<detail::tcp_socket Socket>
+class connector
+{
+public:
+	connector(serial_number_type serial_number);
+
+	[[nodiscard]] std::error_code connect(const char* host, std::uint16_t port);
+
+	[[nodiscard]] std::expected<sensor_value, std::error_code> read_sensor(config::sensor_id id);
+
+	[[nodiscard]] std::error_code read_sensors(std::span<const config::sensor_id> sensor_ids, std::span<sensor_value> values);
+
+	/**
+	 * @brief Reads the sensors straight into columns of doubles, skipping the per sensor `sensor_value` construction.
+	 *
+	 * Raw values are gathered while the responses arrive, scale and offset of all sensors
+	 * are applied in one vectorized pass at the end.
+	 */
+	[[nodiscard]] std::error_code read_sensors(std::span<const config::sensor_id> sensor_ids, sensor_columns columns);
+
+	/**
+	 * @brief Reads a fixed set of sensors with a read plan that is computed at compile time.
+	 *
+	 * @tparam SensorIds The sensors to read, usually a `constexpr std::array<config::sensor_id, N>`.
+	 * @tparam Config The cost model and frame limit the plan is computed with.
+	 *
+	 * @return The sensor values in the order of `SensorIds` or the first error that occurred.
+	 * Since the plan is computed from `config::sensors` it fails with `sensor_table_mismatch` while another table is set.
+	 */
+	template<auto SensorIds, read_plan_config Config = read_plan_config{}>
+	[[nodiscard]] std::expected<std::array<sensor_value, SensorIds.size()>, std::error_code> read_sensors();
+
+	/**
+	 * @brief Encodes the value with the representation of the sensor and writes its registers.
+	 */
+	[[nodiscard]] std::error_code write_sensor(config::sensor_id id, const sensor_value& value);
+
+	/**
+	 * @brief Writes all values, sensors with adjacent registers are merged into as few write requests as possible.
+	 *
+	 * All values are encoded and the sensors checked before the first request is sent, so a value that can't be
+	 * encoded writes nothing. Sensors that share registers or are given twice can't be written in the same call.
+	 */
+	[[nodiscard]] std::error_code write_sensors(std::span<const config::sensor_id> sensor_ids, std::span<const sensor_value> values);
+
+	/**
+	 * @brief Reads the registers of all `ranges` into one image, `image[0]` holds the register at `image_begin_address`.
+	 *
+	 * The ranges are requested like the ranges of a sensor read, so they are pipelined and served from the cache.
+	 * Registers of the image outside of the ranges are left untouched.
+	 */
+	[[nodiscard]] std::error_code read_register_image(
+		std::span<const register_range> ranges,
+		std::uint16_t image_begin_address,
+		std::span<std::uint16_t> image
+	);
+
+	[[nodiscard]] std::error_code disconnect();
+
+	[[nodiscard]] serial_number_type& serial_number();
+	[[nodiscard]] const serial_number_type& serial_number() const;
+
+	[[nodiscard]] read_plan_config& read_plan();
+	[[nodiscard]] const read_plan_config& read_plan() const;
+
+	/**
+	 * @brief Sets the deadlines of the socket operations, effective immediately.
+	 *
+	 * A timed out operation fails with `connector_error::codes::operation_timed_out`.
+	 * Since a frame may have been transferred partially the connection should be reestablished afterwards.
+	 */
+	void set_timeouts(const timeout_config& timeouts);
+	[[nodiscard]] const timeout_config& timeouts() const;
+
+	/**
+	 * @brief Serves reads from registers read within the last `ttl`, only expired registers are requested.
+	 *
+	 * Expired registers of a range are requested in as few sub-ranges as the read plan's round trip cost allows.
+	 * Only the `detail::register_cache::size` registers from the lowest address of the sensor table are cached,
+	 * so ranges of tables that span more addresses are always read from the logger. A ttl of zero disables the cache.
+	 */
+	void set_cache_ttl(std::chrono::milliseconds ttl);
+	[[nodiscard]] std::chrono::milliseconds cache_ttl() const;
+
+	void clear_cache();
+
+	/**
+	 * @brief Reads and writes the sensors of another register layout, for example a loaded `register_profile`.
+	 *
+	 * Sensor ids index into the table, which has to outlive the connector or the next call.
+	 * The default is `config::sensors`. The register cache is cleared and moved to the addresses of the table.
+	 *
+	 * @return `connector_error::codes::invalid_profile` if the table isn't sorted by address or too large.
+	 */
+	[[nodiscard]] std::error_code set_sensors(std::span<const sensor_meta> sensors);
+	[[nodiscard]] std::span<const sensor_meta> sensors() const;
+
+protected:
+	[[nodiscard]] std::expected<std::span<std::uint16_t>, std::error_code> read_registers(std::uint16_t begin_address, std::uint16_t register_count);
+
+	[[nodiscard]] std::error_code write_registers(std::uint16_t begin_address, std::span<const std::uint16_t> values);
+
+	template<class F, class G>
+	[[nodiscard]] std::error_code modbus_request(std::size_t data_size, F&& write_request, G&& read_request);
+
+	/**
+	 * @brief Reads all `ranges` while keeping up to `max_frames_in_flight` requests outstanding.
+	 *
+	 * @param on_registers Called with the index of a range and its registers in the order the responses arrive.
+	 */
+	template<class F>
+	[[nodiscard]] std::error_code read_register_ranges(
+		std::span<const register_range> ranges,
+		std::uint8_t max_frames_in_flight,
+		F&& on_registers
+	);
+
+	/**
+	 * @brief Plans the reads of `sensor_ids` with the current read plan and reads all ranges.
+	 *
+	 * @param on_registers Called with every planned range and its registers.
+	 */
+	template<class F>
+	[[nodiscard]] std::error_code read_planned_ranges(std::span<const config::sensor_id> sensor_ids, F&& on_registers);
+
+	/**
+	 * @return The sequence number the frame was sent with.
+	 */
+	template<class F>
+	[[nodiscard]] std::expected<std::uint8_t, std::error_code> send_modbus_frame(std::size_t data_size, F&& write_request);
+
+	/**
+	 * @brief Sends a read request of `range`.
+	 *
+	 * @return The sequence number the frame was sent with.
+	 */
+	[[nodiscard]] std::expected<std::uint8_t, std::error_code> send_read_request(const register_range& range);
+
+	/**
+	 * @param is_awaited Called with the sequence number of every received frame,
+	 * frames it rejects are late responses to earlier failed requests and get dropped.
+	 * @param read_request Called with the sequence number of the frame and its modbus response.
+	 */
+	template<class P, class F>
+	[[nodiscard]] std::error_code receive_modbus_frame(P&& is_awaited, F&& read_request);
+
+	/**
+	 * @brief Receives and drops the responses of requests still outstanding after `error`,
+	 * so they aren't taken for the responses of the following requests.
+	 *
+	 * @return `error`
+	 */
+	[[nodiscard]] std::error_code discard_responses(std::size_t count, std::error_code error);
+
+	static constexpr std::size_t buffer_size = 2048;
+
+	// Upper bound for `read_plan_config::max_frames_in_flight`.
+	static constexpr std::size_t max_pipeline_depth = 16;
+
+private:
+	// Rebuilds the frame template after the serial number was changed.
+	const detail::modbus::frame_template& current_frame_template();
+
+	Socket m_socket{};
+	std::array<std::uint8_t, buffer_size> m_buffer{};
+	detail::modbus::frame_template m_frame_template{};
+	detail::frame_reader<buffer_size> m_reader{};
+	serial_number_type m_serial_number{};
+	std::uint8_t m_sequence_number{};
+	read_plan_config m_read_plan{};
+	timeout_config m_timeouts{};
+	std::chrono::milliseconds m_cache_ttl{ 0 };
+	detail::register_cache m_cache{};
+	std::span<const sensor_meta> m_sensors;
+};
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+constexpr deye::sensor_value_rep::sensor_value_rep(registers rep) : m_data{ std::move(rep) } {}
+constexpr deye::sensor_value_rep::sensor_value_rep(integer rep) : m_data{ std::move(rep) } {}
+constexpr deye::sensor_value_rep::sensor_value_rep(physical rep) : m_data{ std::move(rep) } {}
+constexpr deye::sensor_value_rep::sensor_value_rep(enumeration rep) : m_data{ std::move(rep) } {}
+
+constexpr deye::sensor_value_rep_id deye::sensor_value_rep::type() const
+{
+	// To match up with the id enum the "empty" value of `sensor_value` is skipped.
+	return static_cast<sensor_value_rep_id>(m_data.index() + 1);
+}
+
+template<class T>
+constexpr std::optional<T> deye::sensor_value_rep::get() const
+{
+	if (const auto ptr = std::get_if<T>(&m_data); ptr != nullptr)
+	{
+		return *ptr;
+	}
+	return std::nullopt;
+}
+
+inline std::expected<deye::sensor_value, std::error_code> deye::sensor_value_rep::interpret(
+	std::span<const std::uint16_t> raw_registers
+) const {
+	auto integer_value = std::uint64_t{};
+
+	if (type() == sensor_value_rep_id::registers)
+	{
+		if (raw_registers.size() > registers::max_size)
+		{
+			return std::unexpected{ std::make_error_code(std::errc::result_out_of_range) };
+		}
+	}
+	else
+	{
+		if (raw_registers.size_bytes() > sizeof(integer_value))
+		{
+			return std::unexpected{ std::make_error_code(std::errc::result_out_of_range) };
+		}
+		std::memcpy(&integer_value, raw_registers.data(), raw_registers.size_bytes());
+	}
+
+	return std::visit(
+		detail::overloaded_lambda{
+			[&](const registers&) -> sensor_value
+			{
+				auto value = sensor_value::registers{};
+				std::ranges::copy(raw_registers, value.data.begin());
+				return { value };
+			},
+			[&](const integer& rep) -> sensor_value
+			{
+				auto value = static_cast<std::int64_t>(integer_value);
+				value *= rep.scale;
+				value += rep.offset;
+				return {
+					sensor_value::integer{
+						.value = value
+					}
+				};
+			},
+			[&](const physical& rep) -> sensor_value
+			{
+				auto value = static_cast<double>(integer_value);
+				value *= rep.scale;
+				value += rep.offset;
+				return {
+					sensor_value::physical{
+						.value = value,
+						.unit_id = rep.unit_id
+					}
+				};
+			},
+			[&](const enumeration& rep) -> sensor_value
+			{
+				const auto index = integer_value;
+				return {
+					sensor_value::enumeration{
+						.index = index,
+						.enum_id = rep.enum_id
+					}
+				};
+			},
+		},
+		m_data
+	);
+}
+
+constexpr deye::sensor_value::sensor_value() : m_data{ empty{} } {}
+constexpr deye::sensor_value::sensor_value(registers value) : m_data{ std::move(value) } {}
+constexpr deye::sensor_value::sensor_value(integer value) : m_data{ std::move(value) } {}
+constexpr deye::sensor_value::sensor_value(enumeration value) : m_data{ std::move(value) } {}
+constexpr deye::sensor_value::sensor_value(physical value) : m_data{ std::move(value) } {}
+
+deye::sensor_value_rep_id deye::sensor_value::type() const
+{
+	return static_cast<sensor_value_rep_id>(m_data.index());
+}
+
+template<class T>
+std::optional<T> deye::sensor_value::get() const
+{
+	if (const auto ptr = std::get_if<T>(&m_data); ptr != nullptr)
+	{
+		return *ptr;
+	}
+	return std::nullopt;
+}
+
+template<class... F>
+auto deye::sensor_value::visit(F&&... visitors)
+{
+	return std::visit(
+		detail::overloaded_lambda{
+			std::forward<F>(visitors)...
+		},
+		m_data
+	);
+}
+
+template<class... F>
+auto deye::sensor_value::visit(F&&... visitors) const
+{
+	return std::visit(
+		detail::overloaded_lambda{
+			std::forward<F>(visitors)...
+		},
+		m_data
+	);
+}
+
+#include "deye_config.hpp"
+
+static_assert(
+	std::ranges::is_sorted(deye::config::sensors, {}, &deye::sensor_meta::begin_address),
+	"The read planner relies on the sensor table being sorted by address."
+);
+
+static_assert(
+	deye::config::sensors.size() <= deye::max_sensor_table_size,
+	"The built-in sensor table exceeds the planners buffers."
+);
+
+namespace deye::detail
+{
+
+template<auto SensorIds, read_plan_config Config>
+struct read_planner::static_plan
+{
+	static_assert(
+		std::ranges::all_of(SensorIds, [](const config::sensor_id id) {
+			return static_cast<std::size_t>(id) < config::sensors.size();
+		}),
+		"Unknown sensor id in static read plan."
+	);
+
+	struct sensor_slot
+	{
+		std::size_t sensor_index, range_index;
+		std::uint16_t offset;
+	};
+
+private:
+	static consteval auto plan_ranges()
+	{
+		auto requested = std::array<bool, config::sensors.size()>{};
+		for (const auto id : SensorIds)
+		{
+			requested[static_cast<std::size_t>(id)] = true;
+		}
+
+		auto planned = std::array<register_range, SensorIds.size()>{};
+		auto count = std::size_t{};
+
+		[[maybe_unused]] const auto stopped = for_each_range(
+			config::sensors,
+			[&](const std::size_t index) { return requested[index]; },
+			Config,
+			[&](const register_range& range)
+			{
+				planned[count++] = range;
+				return false;
+			}
+		);
+
+		return std::pair{ planned, count };
+	}
+
+	static constexpr auto planned_ranges = plan_ranges();
+
+public:
+	static constexpr auto ranges = []
+	{
+		auto exact = std::array<register_range, planned_ranges.second>{};
+		std::ranges::copy_n(planned_ranges.first.begin(), exact.size(), exact.begin());
+		return exact;
+	}();
+
+	static constexpr auto slots = []
+	{
+		auto sensor_slots = std::array<sensor_slot, SensorIds.size()>{};
+
+		for (std::size_t i{}; i != SensorIds.size(); ++i)
+		{
+			const auto sensor_index = static_cast<std::size_t>(SensorIds[i]);
+			const auto& sensor = config::sensors[sensor_index];
+
+			const auto range_it = std::ranges::find_if(ranges, [&](const register_range& range) {
+				return (
+					range.begin_address <= sensor.begin_address and
+					sensor.begin_address + sensor.register_count <= range.begin_address + range.register_count
+				);
+			});
+
+			sensor_slots[i] = {
+				.sensor_index = sensor_index,
+				.range_index = static_cast<std::size_t>(range_it - ranges.begin()),
+				.offset = static_cast<std::uint16_t>(sensor.begin_address - range_it->begin_address)
+			};
+		}
+
+		return sensor_slots;
+	}();
+
+	static constexpr auto max_register_count = std::ranges::max(
+		ranges | std::views::transform(&register_range::register_count)
+	);
+
+	static constexpr auto request_frame_size = modbus::request_frame_size(modbus::read_request_size);
+	static constexpr auto max_response_frame_size = modbus::read_response_frame_size(max_register_count);
+};
+
+/**
+ * @brief Decodes the registers of a sensor known at compile time,
+ * the equivalent of `sensor_value_rep::interpret` without any runtime dispatch.
+ */
+template<std::size_t SensorIndex>
+[[nodiscard]] sensor_value decode_sensor(const std::uint16_t* raw_registers)
+{
+	static constexpr const auto& sensor = config::sensors[SensorIndex];
+
+	if constexpr (sensor.rep.type() == sensor_value_rep_id::registers)
+	{
+		static_assert(sensor.register_count <= sensor_value::registers::max_size);
+
+		auto value = sensor_value::registers{};
+		std::copy_n(raw_registers, sensor.register_count, value.data.begin());
+		return { value };
+	}
+	else
+	{
+		static_assert(sensor.register_count * sizeof(std::uint16_t) <= sizeof(std::uint64_t));
+
+		auto integer_value = std::uint64_t{};
+		std::memcpy(&integer_value, raw_registers, sensor.register_count * sizeof(std::uint16_t));
+
+		if constexpr (sensor.rep.type() == sensor_value_rep_id::integer)
+		{
+			static constexpr auto rep = *sensor.rep.template get<sensor_value_rep::integer>();
+			return {
+				sensor_value::integer{
+					.value = static_cast<std::int64_t>(integer_value) * rep.scale + rep.offset
+				}
+			};
+		}
+		else if constexpr (sensor.rep.type() == sensor_value_rep_id::physical)
+		{
+			static constexpr auto rep = *sensor.rep.template get<sensor_value_rep::physical>();
+			return {
+				sensor_value::physical{
+					.value = static_cast<double>(integer_value) * rep.scale + rep.offset,
+					.unit_id = rep.unit_id
+				}
+			};
+		}
+		else
+		{
+			static constexpr auto rep = *sensor.rep.template get<sensor_value_rep::enumeration>();
+			return {
+				sensor_value::enumeration{
+					.index = integer_value,
+					.enum_id = rep.enum_id
+				}
+			};
+		}
+	}
+}
+
+} // namespace deye::detail
+
+
+//--------------[ connector implementation ]--------------//
+
+namespace deye::connector_error
+{
+enum class codes
+{
+	ok = 0,
+	action_exceeds_local_buffer_size,
+	too_many_register_values,
+	serial_number_mismatch,
+	device_address_mismatch,
+	unknown_response_code,
+	response_invalid_start,
+	response_invalid_end,
+	response_wrong_checksum,
+	response_wrong_crc,
+	response_wrong_address,
+	response_wrong_register_count,
+	num_sensors_values_mismatch,
+	unknown_sensor,
+	unknown_unit,
+	internal_error,
+	// The values are part of the interface, new codes go to the end.
+	operation_timed_out,
+	response_wrong_sequence_number,
+	value_type_mismatch,
+	value_out_of_range,
+	overlapping_sensor_writes,
+	invalid_profile,
+	sensor_table_mismatch,
+	duplicate_sensor_writes
+};
+
+struct category : std::error_category
 {
 	[[nodiscard]] const char* name() const noexcept override
 	{
-		return "deye_connector";
+		return "deye_connector";
+	}
+	[[nodiscard]] std::string message(int ev) const override
+	{
+		switch (static_cast<codes>(ev))
+		{
+		case codes::action_exceeds_local_buffer_size:
+			return "Action would exceed local buffer size.";
+		case codes::too_many_register_values:
+			return "The number of given values exceeds what can be written in one request.";
+		case codes::device_address_mismatch:
+			return "Device address does not match.";
+		case codes::serial_number_mismatch:
+			return "Serial Number does not match.";
+		case codes::unknown_response_code:
+			return "Unknown response error code.";
+		case codes::response_invalid_start:
+			return "Response frame has invalid starting byte";
+		case codes::response_invalid_end:
+			return "Response frame has invalid ending byte";
+		case codes::response_wrong_checksum:
+			return "Response frame checksum is not valid.";
+		case codes::response_wrong_crc:
+			return "Response frame crc is not valid.";
+		case codes::response_wrong_address:
+			return "Returned address does not match sent value.";
+		case codes::response_wrong_register_count:
+			return "Returned register count does not match sent value.";
+		case codes::num_sensors_values_mismatch:
+			return "Size of given value range does not match number of given sensor types.";
+		case codes::unknown_sensor:
+			return "Unknown sensor enum value.";
+		case codes::unknown_unit:
+			return "Unknown unit enum value.";
+		case codes::internal_error:
+			return "Internal error";
+		case codes::operation_timed_out:
+			return "Socket operation did not complete within its deadline.";
+		case codes::response_wrong_sequence_number:
+			return "Response frame sequence number does not match any pending request.";
+		case codes::value_type_mismatch:
+			return "Value does not match the representation of the sensor.";
+		case codes::value_out_of_range:
+			return "Value can not be represented by the registers of the sensor.";
+		case codes::overlapping_sensor_writes:
+			return "Written sensors share registers.";
+		case codes::invalid_profile:
+			return "Register profile is malformed, unsorted or has too many sensors.";
+		case codes::sensor_table_mismatch:
+			return "Operation only supports the built-in sensor table.";
+		case codes::duplicate_sensor_writes:
+			return "Written sensor is given more than once.";
+		default:
+			return std::format("Device returned different serial number: {}", static_cast<serial_number_type>(ev));
+		}
+	}
+};
+
+} // namespace deye::connector_error
+
+inline std::error_category& connector_error_category()
+{
+	static deye::connector_error::category category;
+	return category;
+}
+
+namespace deye::connector_error
+{
+	inline std::error_code make_error_code(codes e)
+	{
+		return { static_cast<int>(e), connector_error_category() };
+	}
+} // namespace deye::connector_error
+
+
+template <>
+struct std::is_error_code_enum<deye::connector_error::codes> : std::true_type {};
+
+inline std::error_code deye::sensor_value_rep::encode(
+	const sensor_value& value,
+	std::span<std::uint16_t> raw_registers
+) const {
+	using connector_error::make_error_code;
+	using connector_error::codes;
+
+	if (value.type() != type())
+	{
+		return make_error_code(codes::value_type_mismatch);
+	}
+
+	if (const auto registers_value = value.get<sensor_value::registers>())
+	{
+		if (raw_registers.size() > registers::max_size)
+		{
+			return std::make_error_code(std::errc::result_out_of_range);
+		}
+		std::copy_n(registers_value->data.begin(), raw_registers.size(), raw_registers.begin());
+		return {};
+	}
+
+	if (raw_registers.size_bytes() > sizeof(std::uint64_t))
+	{
+		return std::make_error_code(std::errc::result_out_of_range);
+	}
+
+	// The largest raw value that fits into the registers.
+	const auto max_value = (
+		raw_registers.size_bytes() == sizeof(std::uint64_t) ?
+		std::numeric_limits<std::uint64_t>::max() :
+		(std::uint64_t{ 1 } << (raw_registers.size_bytes() * 8)) - 1
+	);
+
+	const auto integer_value = std::visit(
+		detail::overloaded_lambda{
+			[&](const registers&) -> std::expected<std::uint64_t, std::error_code>
+			{
+				return std::unexpected{ make_error_code(codes::internal_error) };
+			},
+			[&](const integer& rep) -> std::expected<std::uint64_t, std::error_code>
+			{
+				const auto difference = value.get<sensor_value::integer>()->value - rep.offset;
+				if (
+					(rep.scale == 0 and difference != 0) or
+					(rep.scale != 0 and difference % rep.scale != 0)
+				) {
+					return std::unexpected{ make_error_code(codes::value_out_of_range) };
+				}
+
+				const auto raw = rep.scale == 0 ? 0 : difference / rep.scale;
+				if (raw < 0 or static_cast<std::uint64_t>(raw) > max_value)
+				{
+					return std::unexpected{ make_error_code(codes::value_out_of_range) };
+				}
+
+				return static_cast<std::uint64_t>(raw);
+			},
+			[&](const physical& rep) -> std::expected<std::uint64_t, std::error_code>
+			{
+				const auto physical_value = *value.get<sensor_value::physical>();
+				if (physical_value.unit_id != rep.unit_id)
+				{
+					return std::unexpected{ make_error_code(codes::value_type_mismatch) };
+				}
+
+				const auto raw = std::round((physical_value.value - rep.offset) / rep.scale);
+				if (not (raw >= 0.0 and raw <= static_cast<double>(max_value)))
+				{
+					return std::unexpected{ make_error_code(codes::value_out_of_range) };
+				}
+
+				return static_cast<std::uint64_t>(raw);
+			},
+			[&](const enumeration& rep) -> std::expected<std::uint64_t, std::error_code>
+			{
+				const auto enumeration_value = *value.get<sensor_value::enumeration>();
+				if (enumeration_value.enum_id != rep.enum_id)
+				{
+					return std::unexpected{ make_error_code(codes::value_type_mismatch) };
+				}
+
+				const auto names = enumeration_by_id(rep.enum_id);
+				if (not names or enumeration_value.index >= names->names.size())
+				{
+					return std::unexpected{ make_error_code(codes::value_out_of_range) };
+				}
+
+				return static_cast<std::uint64_t>(enumeration_value.index);
+			},
+		},
+		m_data
+	);
+
+	if (not integer_value)
+	{
+		return integer_value.error();
+	}
+
+	std::memcpy(raw_registers.data(), &*integer_value, raw_registers.size_bytes());
+
+	return {};
+}
+
+namespace deye::detail
+{
+
+// Sockets report expired deadlines as `std::errc::timed_out`, the connector has its own code for it.
+[[nodiscard]] inline std::error_code socket_error(const std::error_code error)
+{
+	if (error == std::errc::timed_out)
+	{
+		return connector_error::make_error_code(connector_error::codes::operation_timed_out);
+	}
+	return error;
+}
+
+} // namespace deye::detail
+
+
+constexpr std::optional<deye::sensor_meta> deye::sensor_meta_by_id(config::sensor_id id)
+{
+	if (const auto index = static_cast<std::size_t>(id); index < config::sensors.size())
+	{
+		return config::sensors[index];
+	}
+	else
+	{
+		return std::nullopt;
+	}
+}
+
+constexpr std::optional<deye::physical_unit> deye::physical_unit_by_id(config::physical_unit_id id)
+{
+	const auto index = static_cast<std::size_t>(id);
+	if (index < config::physical_units.size())
+	{
+		return config::physical_units[index];
+	}
+	else
+	{
+		return std::nullopt;
+	}
+}
+
+constexpr std::optional<deye::enumeration> deye::enumeration_by_id(config::enumeration_id id)
+{
+	const auto index = static_cast<std::size_t>(id);
+	if (index < config::enumerations.size())
+	{
+		return enumeration{ .names = config::enumerations[index] };
+	}
+	else
+	{
+		return std::nullopt;
+	}
+}
+
+
+//--------------[ byte util implementation ]--------------//
+
+constexpr std::size_t deye::detail::modbus::request_frame_size(const std::size_t request_size)
+{
+	return (
+		header_size					+
+		request_data_field_size		+
+		request_size				+
+		sizeof(std::uint16_t)		+ // crc
+		trailer_size
+	);
+}
+
+constexpr std::size_t deye::detail::modbus::read_response_frame_size(const std::size_t register_count)
+{
+	return (
+		header_size								+
+		response_data_field_size				+
+		3 * sizeof(std::uint8_t)				+ // device address, function code and byte count
+		register_count * sizeof(std::uint16_t)	+
+		sizeof(std::uint16_t)					+ // crc
+		trailer_size
+	);
+}
+
+constexpr std::size_t deye::detail::modbus::write_request_size(const std::size_t register_count)
+{
+	return write_request_header_size + register_count * sizeof(std::uint16_t);
+}
+
+constexpr std::uint8_t deye::detail::modbus::checksum(std::span<const std::uint8_t> data)
+{
+	if consteval
+	{
+		return std::accumulate(data.begin(), data.end(), std::uint8_t{});
+	}
+
+#if defined(__GNUC__)
+	// The checksum is a byte sum modulo 256, which is exactly a lane wise add of 8-bit vectors.
+	// GCC and Clang lower the vector extension to SIMD instructions or to SWAR code on
+	// targets without vector units.
+	using lanes = std::uint8_t __attribute__((vector_size(16)));
+
+	auto sum_a = lanes{}, sum_b = lanes{};
+	auto it = data.data();
+
+	for (auto blocks = data.size() / (2 * sizeof(lanes)); blocks != 0; --blocks)
+	{
+		lanes block_a, block_b;
+		std::memcpy(&block_a, it, sizeof(lanes));
+		std::memcpy(&block_b, it + sizeof(lanes), sizeof(lanes));
+		sum_a += block_a;
+		sum_b += block_b;
+		it += 2 * sizeof(lanes);
+	}
+
+	sum_a += sum_b;
+
+	auto sum = std::uint8_t{};
+	for (std::size_t i{}; i != sizeof(lanes); ++i)
+	{
+		sum += sum_a[i];
+	}
+
+	return std::accumulate(it, data.data() + data.size(), sum);
+#else
+	return std::accumulate(data.begin(), data.end(), std::uint8_t{});
+#endif
+}
+
+namespace deye::detail::modbus
+{
+
+// Lookup tables for slice-by-8 processing of the reflected modbus polynomial 0xA001.
+// `crc_tables[0]` advances the crc by one byte, `crc_tables[n]` by one byte followed by n zero bytes.
+inline constexpr auto crc_tables = []
+{
+	auto tables = std::array<std::array<std::uint16_t, 256>, 8>{};
+
+	for (std::size_t byte{}; byte != 256; ++byte)
+	{
+		auto crc = static_cast<std::uint16_t>(byte);
+		for (int i = 0; i != 8; ++i)
+		{
+			crc = (crc & 0x0001) != 0 ? (crc >> 1) ^ 0xA001 : crc >> 1;
+		}
+		tables[0][byte] = crc;
+	}
+
+	for (std::size_t n = 1; n != tables.size(); ++n)
+	{
+		for (std::size_t byte{}; byte != 256; ++byte)
+		{
+			const auto prev = tables[n - 1][byte];
+			tables[n][byte] = (prev >> 8) ^ tables[0][prev & 0xff];
+		}
+	}
+
+	return tables;
+}();
+
+} // namespace deye::detail::modbus
+
+constexpr std::uint16_t deye::detail::modbus::crc(std::span<const std::uint8_t> data)
+{
+	return crc_update(0xFFFF, data);
+}
+
+constexpr std::uint16_t deye::detail::modbus::crc_update(std::uint16_t crc, std::span<const std::uint8_t> data)
+{
+	const auto& t = crc_tables;
+
+	auto it = data.begin();
+
+	for (auto blocks = data.size() / 8; blocks != 0; --blocks, it += 8)
+	{
+		crc ^= static_cast<std::uint16_t>(it[0] | (it[1] << 8));
+		crc = (
+			t[7][crc & 0xff] ^ t[6][crc >> 8] ^
+			t[5][it[2]] ^ t[4][it[3]] ^
+			t[3][it[4]] ^ t[2][it[5]] ^
+			t[1][it[6]] ^ t[0][it[7]]
+		);
+	}
+
+	for (; it != data.end(); ++it)
+	{
+		crc = (crc >> 8) ^ t[0][(crc ^ *it) & 0xff];
+	}
+
+	return crc;
+}
+
+constexpr std::uint16_t deye::detail::modbus::crc_bitwise(std::span<const std::uint8_t> data)
+{
+	std::uint16_t crc = 0xFFFF;
+
+	for (const auto& byte : data)
+	{
+		crc ^= static_cast<std::uint16_t>(byte);
+
+		for (int i = 0; i != 8; ++i)
+		{
+			if ((crc & 0x0001) != 0) {
+				crc >>= 1;
+				crc ^= 0xA001;
+			} else {
+				crc >>= 1;
+			}
+		}
+	}
+
+	return crc;
+}
+
+static_assert(
+	[]
+	{
+		constexpr auto check_value = std::array<std::uint8_t, 9>{ '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+		if (deye::detail::modbus::crc(check_value) != 0x4B37)
+		{
+			return false;
+		}
+
+		auto data = std::array<std::uint8_t, 67>{};
+		for (std::size_t i{}; i != data.size(); ++i)
+		{
+			data[i] = static_cast<std::uint8_t>(i * 167 + 13);
+		}
+
+		for (std::size_t size{}; size <= data.size(); ++size)
+		{
+			const auto view = std::span{ data.data(), size };
+			if (deye::detail::modbus::crc(view) != deye::detail::modbus::crc_bitwise(view))
+			{
+				return false;
+			}
+
+			const auto split = deye::detail::modbus::crc_update(
+				deye::detail::modbus::crc(view.first(size / 3)),
+				view.subspan(size / 3)
+			);
+			if (split != deye::detail::modbus::crc(view))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}(),
+	"Table driven crc does not match the bitwise reference."
+);
+
+
+template<class P, class F>
+constexpr auto deye::detail::read_planner::for_each_range(
+	std::span<const sensor_meta> sensors,
+	P&& is_requested,
+	const read_plan_config& config,
+	F&& on_range
+) -> std::invoke_result_t<F&, const register_range&> {
+	auto range = register_range{};
+	auto range_end = std::uint32_t{};
+	auto has_range = false;
+
+	for (std::size_t index{}; index != sensors.size(); ++index)
+	{
+		if (not is_requested(index))
+		{
+			continue;
+		}
+
+		const auto& sensor = sensors[index];
+		const auto sensor_end = static_cast<std::uint32_t>(sensor.begin_address) + sensor.register_count;
+
+		if (has_range)
+		{
+			// Since the sensors are sorted the only choice is between extending the current
+			// range over the gap or paying for another round trip.
+			const auto gap = sensor.begin_address > range_end ? sensor.begin_address - range_end : 0;
+			const auto merged_end = std::max(range_end, sensor_end);
+
+			if (
+				gap <= config.round_trip_cost and
+				merged_end - range.begin_address <= config.max_registers_per_frame
+			) {
+				range_end = merged_end;
+				continue;
+			}
+
+			range.register_count = static_cast<std::uint16_t>(range_end - range.begin_address);
+			if (const auto error = on_range(range))
+			{
+				return error;
+			}
+		}
+
+		range.begin_address = sensor.begin_address;
+		range_end = sensor_end;
+		has_range = true;
+	}
+
+	if (has_range)
+	{
+		range.register_count = static_cast<std::uint16_t>(range_end - range.begin_address);
+		return on_range(range);
+	}
+
+	return std::invoke_result_t<F&, const register_range&>{};
+}
+
+
+template<typename T, std::endian Endian>
+std::error_code deye::detail::bytes::from(
+	const auto& value, std::span<std::uint8_t> bytes,
+	std::size_t* offset
+) {
+	if constexpr (is_container<decltype(value), const T>::value)
+	{
+		for (const auto &element : value)
+		{
+			if (const auto error = from<T, Endian>(element, bytes, offset))
+			{
+				return error;
+			}
+		}
+	}
+	else if (*offset >= bytes.size() or (bytes.size() - *offset) < sizeof(T))
+	{
+		return std::make_error_code(std::errc::result_out_of_range);
+	}
+	else
+	{
+		auto t_value = static_cast<T>(value);
+
+		if constexpr (std::integral<T> and Endian != std::endian::native)
+		{
+			t_value = std::byteswap(t_value);
+		}
+
+		std::memcpy(&bytes[*offset], &t_value, sizeof(T));
+
+		*offset += sizeof(T);
+	}
+
+	return {};
+}
+
+template<typename T, std::endian Endian>
+std::error_code deye::detail::bytes::from(
+	const auto& value,
+	std::span<std::uint8_t> bytes,
+	std::size_t offset
+) {
+	return from<T, Endian>(value, bytes, &offset);
+}
+
+template<typename T, std::endian Endian>
+std::expected<T, std::error_code> deye::detail::bytes::to(
+	std::span<const std::uint8_t> bytes,
+	std::size_t* offset
+) {
+	if (*offset >= bytes.size() or (bytes.size() - *offset) < sizeof(T))
+	{
+		return std::unexpected{ std::make_error_code(std::errc::result_out_of_range) };
+	}
+
+	T value;
+
+	std::memcpy(&value, &bytes[*offset], sizeof(T));
+
+	if constexpr (std::integral<T> and Endian != std::endian::native)
+	{
+		value = std::byteswap(value);
+	}
+
+	*offset += sizeof(T);
+
+	return value;
+}
+
+template<typename T, std::endian Endian>
+std::expected<T, std::error_code> deye::detail::bytes::to(
+	std::span<const std::uint8_t> bytes,
+	std::size_t offset
+) {
+	return to<T, Endian>(bytes, &offset);
+}
+
+//--------------[ frame implementation ]--------------//
+
+template<class F>
+std::expected<std::span<std::uint8_t>, std::error_code> deye::detail::modbus::encode_frame(
+	std::span<std::uint8_t> buffer,
+	const serial_number_type serial_number,
+	const std::uint8_t sequence_number,
+	const std::size_t data_size,
+	F&& write_request
+) {
+	return frame_template{ serial_number }.encode(buffer, sequence_number, data_size, std::forward<F>(write_request));
+}
+
+inline deye::detail::modbus::frame_template::frame_template(const serial_number_type serial_number) :
+	m_serial_number{ serial_number }
+{
+	auto offset = std::size_t{};
+
+	// The prefix is sized to fit, so encoding it can't fail.
+	[[maybe_unused]] const auto failed = (
+		bytes::from<std::uint8_t	    , std::endian::little>(0xa5			, m_prefix, &offset) or // start byte
+		bytes::from<std::uint16_t	    , std::endian::little>(0x0000		, m_prefix, &offset) or // payload size
+		bytes::from<std::uint16_t	    , std::endian::little>(0x4510		, m_prefix, &offset) or // control code
+		bytes::from<std::uint16_t		, std::endian::little>(0x0000		, m_prefix, &offset) or // sequence number
+		bytes::from<serial_number_type, std::endian::little>(serial_number	, m_prefix, &offset) or // serial number
+		bytes::from<std::uint8_t		, std::endian::little>(0x2			, m_prefix, &offset) or // data field
+		bytes::from<std::uint16_t		, std::endian::little>(0x00			, m_prefix, &offset) or // "
+		bytes::from<std::uint32_t		, std::endian::little>(0x0000		, m_prefix, &offset) or // "
+		bytes::from<std::uint64_t		, std::endian::little>(0x00000000	, m_prefix, &offset) 	// "
+	);
+
+	static constexpr auto ignore_start_byte = sizeof(std::uint8_t);
+	m_prefix_checksum = checksum(std::span{ m_prefix }.subspan(ignore_start_byte));
+}
+
+inline deye::serial_number_type deye::detail::modbus::frame_template::serial_number() const
+{
+	return m_serial_number;
+}
+
+template<class F>
+std::expected<std::span<std::uint8_t>, std::error_code> deye::detail::modbus::frame_template::encode(
+	std::span<std::uint8_t> buffer,
+	const std::uint8_t sequence_number,
+	const std::size_t data_size,
+	F&& write_request
+) const {
+	using connector_error::make_error_code;
+	using connector_error::codes;
+
+	const auto payload_size = static_cast<std::uint16_t>(
+		request_data_field_size	+	// data field
+		data_size				+	// data
+		sizeof(std::uint16_t) 		// crc
+	);
+
+	const auto frame_size = request_frame_size(data_size);
+
+	if (frame_size > buffer.size())
+	{
+		return std::unexpected{ make_error_code(codes::action_exceeds_local_buffer_size) };
+	}
+
+	auto frame = buffer.subspan(0, frame_size);
+
+	std::ranges::copy(m_prefix, frame.begin());
+	frame[payload_size_offset] = static_cast<std::uint8_t>(payload_size);
+	frame[payload_size_offset + 1] = static_cast<std::uint8_t>(payload_size >> 8);
+	frame[sequence_number_offset] = sequence_number;
+
+	auto data = frame.subspan(prefix_size, data_size);
+	if (const auto error = write_request(data))
+	{
+		return std::unexpected{ error };
+	}
+
+	auto offset = prefix_size + data_size;
+
+	const auto data_crc = crc(data);
+	if (const auto error = bytes::from<std::uint16_t, std::endian::little>(data_crc, frame, &offset))
+	{
+		return std::unexpected{ error };
+	}
+
+	// Only the patched fields and the bytes behind the prefix are added to the checksum of the prefix.
+	const auto frame_checksum = static_cast<std::uint8_t>(
+		m_prefix_checksum +
+		frame[payload_size_offset] + frame[payload_size_offset + 1] +
+		sequence_number +
+		checksum(frame.subspan(prefix_size, offset - prefix_size))
+	);
+
+	if (std::error_code error;
+	    ((error = bytes::from<std::uint8_t , std::endian::little>(frame_checksum,	frame, &offset))) or // checksum
+	    ((error = bytes::from<std::uint8_t , std::endian::little>(0x15,	frame, &offset)))	  // end byte
+	) {
+		return std::unexpected{ error };
+	}
+
+	return frame;
+}
+
+inline void deye::detail::modbus::frame_template::set_sequence_number(
+	std::span<std::uint8_t> frame,
+	const std::uint8_t sequence_number
+) {
+	auto& frame_checksum = frame[frame.size() - trailer_size];
+	frame_checksum = static_cast<std::uint8_t>(frame_checksum - frame[sequence_number_offset] + sequence_number);
+	frame[sequence_number_offset] = sequence_number;
+}
+
+inline std::expected<std::size_t, std::error_code> deye::detail::modbus::check_header(std::span<const std::uint8_t> header)
+{
+	using connector_error::make_error_code;
+	using connector_error::codes;
+
+	if (header.size() < header_size)
+	{
+		return std::unexpected{ make_error_code(codes::internal_error) };
+	}
+
+	if (header.front() != 0xa5)
+	{
+		return std::unexpected{ make_error_code(codes::response_invalid_start) };
+	}
+
+	const auto data_size = bytes::to<std::uint16_t, std::endian::little>(header, 1);
+	if (not data_size)
+	{
+		return std::unexpected{ data_size.error() };
+	}
+
+	return header_size + *data_size + trailer_size;
+}
+
+inline std::error_code deye::detail::modbus::check_serial_number(
+	std::span<const std::uint8_t> header,
+	const serial_number_type serial_number
+) {
+	if (const auto returned_serial_number = bytes::to<serial_number_type, std::endian::little>(header, 7))
+	{
+		if (returned_serial_number.value() != serial_number)
+		{
+			// TODO this will lose precision on 32 bits and smaller machines.
+			return std::error_code{ static_cast<int>(returned_serial_number.value()), connector_error_category() };
+		}
+	}
+
+	return {};
+}
+
+inline std::uint8_t deye::detail::modbus::header_sequence_number(std::span<const std::uint8_t> header)
+{
+	// The low byte echoes the sequence number of the request, the high byte is the loggers own counter.
+	return header[5];
+}
+
+template<std::size_t Capacity>
+void deye::frame_decoder<Capacity>::discard_returned_frame()
+{
+	m_begin += m_returned_size;
+	m_returned_size = 0;
+
+	if (m_begin == m_end)
+	{
+		m_begin = m_end = 0;
+	}
+}
+
+template<std::size_t Capacity>
+std::span<std::uint8_t> deye::frame_decoder<Capacity>::prepare()
+{
+	discard_returned_frame();
+
+	// Frames are handed out as contiguous spans, so move the remainder to the front instead of wrapping around.
+	const auto required_size = m_state == state::header ? detail::modbus::header_size : m_frame_size;
+	if (m_begin != 0 and (m_end == m_buffer.size() or m_begin + required_size > m_buffer.size()))
+	{
+		std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+		m_end -= m_begin;
+		m_begin = 0;
+	}
+
+	return std::span{ m_buffer }.subspan(m_end);
+}
+
+template<std::size_t Capacity>
+void deye::frame_decoder<Capacity>::commit(const std::size_t size)
+{
+	m_end = std::min(m_end + size, m_buffer.size());
+}
+
+template<std::size_t Capacity>
+std::size_t deye::frame_decoder<Capacity>::feed(std::span<const std::uint8_t> bytes)
+{
+	const auto free_space = prepare();
+	const auto size = std::min(free_space.size(), bytes.size());
+	std::copy_n(bytes.begin(), size, free_space.begin());
+	commit(size);
+	return size;
+}
+
+template<std::size_t Capacity>
+std::expected<std::span<std::uint8_t>, std::error_code> deye::frame_decoder<Capacity>::next(
+	const serial_number_type serial_number
+) {
+	using connector_error::make_error_code;
+	using connector_error::codes;
+	using namespace detail::modbus;
+
+	static_assert(header_size < Capacity);
+
+	discard_returned_frame();
+	m_rejected = false;
+
+	const auto received = std::span{ m_buffer.data() + m_begin, m_end - m_begin };
+
+	if (m_state == state::header)
+	{
+		if (received.empty())
+		{
+			return std::span<std::uint8_t>{};
+		}
+
+		// Fail on a garbage byte right away instead of waiting for a complete header.
+		if (received.front() != 0xa5)
+		{
+			reset();
+			return std::unexpected{ make_error_code(codes::response_invalid_start) };
+		}
+
+		if (received.size() < header_size)
+		{
+			return std::span<std::uint8_t>{};
+		}
+
+		const auto frame_size = check_header(received);
+		if (not frame_size)
+		{
+			reset();
+			return std::unexpected{ frame_size.error() };
+		}
+
+		if (*frame_size > m_buffer.size())
+		{
+			reset();
+			return std::unexpected{ make_error_code(codes::action_exceeds_local_buffer_size) };
+		}
+
+		m_frame_error = check_serial_number(received, serial_number);
+		m_frame_size = *frame_size;
+		m_parsed = sizeof(std::uint8_t); // the checksum excludes the start byte
+		m_checksum = 0;
+		m_crc = 0xFFFF;
+		m_state = state::body;
+	}
+
+	// Error responses carry a status code instead of a modbus response and crc.
+	const auto has_crc = m_frame_size != header_size + 18;
+
+	// The modbus response and its crc sit between the data field and the trailer.
+	const auto crc_begin = header_size + response_data_field_size;
+	const auto crc_end = m_frame_size - trailer_size - sizeof(std::uint16_t);
+
+	if (m_state == state::body)
+	{
+		const auto body_end = std::min(received.size(), m_frame_size - trailer_size);
+
+		if (body_end > m_parsed)
+		{
+#ifdef DEYE_REDUNDANT_ERROR_CHECKS
+			m_checksum += checksum(received.subspan(m_parsed, body_end - m_parsed));
+
+			if (has_crc)
+			{
+				const auto begin = std::max(m_parsed, crc_begin);
+				const auto end = std::min(body_end, crc_end);
+				if (begin < end)
+				{
+					m_crc = crc_update(m_crc, received.subspan(begin, end - begin));
+				}
+			}
+#endif
+			m_parsed = body_end;
+		}
+
+		if (m_parsed == m_frame_size - trailer_size)
+		{
+			m_state = state::trailer;
+		}
 	}
-	[[nodiscard]] std::string message(int ev) const override
+
+	if (received.size() < m_frame_size)
 	{
-		switch (static_cast<codes>(ev))
+		return std::span<std::uint8_t>{};
+	}
+
+	const auto frame = received.first(m_frame_size);
+
+	m_state = state::header;
+	m_returned_size = m_frame_size;
+
+	// The length field pointed somewhere into the middle of the stream.
+	if (frame.back() != 0x15)
+	{
+		reset();
+		return std::unexpected{ make_error_code(codes::response_invalid_end) };
+	}
+
+	if (m_frame_error)
+	{
+		m_rejected = true;
+		return std::unexpected{ m_frame_error };
+	}
+
+#ifdef DEYE_REDUNDANT_ERROR_CHECKS
+	if (frame[m_frame_size - trailer_size] != m_checksum)
+	{
+		m_rejected = true;
+		return std::unexpected{ make_error_code(codes::response_wrong_checksum) };
+	}
+
+	if (has_crc and crc_begin < crc_end)
+	{
+		const auto actual_crc = static_cast<std::uint16_t>(frame[crc_end] | (frame[crc_end + 1] << 8));
+		if (actual_crc != m_crc)
 		{
-		case codes::action_exceeds_local_buffer_size:
-			return "Action would exceed local buffer size.";
-		case codes::too_many_register_values:
-			return "The number of given values exceeds what can be written in one request.";
-		case codes::device_address_mismatch:
-			return "Device address does not match.";
-		case codes::serial_number_mismatch:
-			return "Serial Number does not match.";
-		case codes::unknown_response_code:
-			return "Unknown response error code.";
-		case codes::response_invalid_start:
-			return "Response frame has invalid starting byte";
-		case codes::response_invalid_end:
-			return "Response frame has invalid ending byte";
-		case codes::response_wrong_checksum:
-			return "Response frame checksum is not valid.";
-		case codes::response_wrong_crc:
-			return "Response frame crc is not valid.";
-		case codes::response_wrong_address:
-			return "Returned address does not match sent value.";
-		case codes::response_wrong_register_count:
-			return "Returned register count does not match sent value.";
-		case codes::num_sensors_values_mismatch:
-			return "Size of given value range does not match number of given sensor types.";
-		case codes::unknown_sensor:
-			return "Unknown sensor enum value.";
-		case codes::unknown_unit:
-			return "Unknown unit enum value.";
-		case codes::internal_error:
-			return "Internal error";
-		default:
-			return std::format("Device returned different serial number: {}", static_cast<serial_number_type>(ev));
+			m_rejected = true;
+			return std::unexpected{ make_error_code(codes::response_wrong_crc) };
 		}
 	}
-};
+#endif
 
-} // namespace deye::connector_error
+	return frame;
+}
 
-inline std::error_category& connector_error_category()
+template<std::size_t Capacity>
+std::span<const std::uint8_t> deye::frame_decoder<Capacity>::rejected_frame() const
 {
-	static deye::connector_error::category category;
-	return category;
+	if (not m_rejected)
+	{
+		return {};
+	}
+	return std::span{ m_buffer.data() + m_begin, m_returned_size };
 }
 
-namespace deye::connector_error
+template<std::size_t Capacity>
+std::size_t deye::frame_decoder<Capacity>::bytes_needed() const
 {
-	inline std::error_code make_error_code(codes e)
+	const auto available = m_end - m_begin - m_returned_size;
+	const auto required_size = m_state == state::header ? detail::modbus::header_size : m_frame_size;
+	return required_size > available ? required_size - available : 0;
+}
+
+template<std::size_t Capacity>
+void deye::frame_decoder<Capacity>::reset()
+{
+	m_begin = m_end = m_parsed = m_frame_size = m_returned_size = 0;
+	m_state = state::header;
+	m_frame_error.clear();
+	m_rejected = false;
+}
+
+template<std::size_t Capacity>
+template<deye::detail::tcp_socket Socket>
+std::expected<std::span<std::uint8_t>, std::error_code> deye::detail::frame_reader<Capacity>::next_frame(
+	Socket& socket,
+	const serial_number_type serial_number
+) {
+	while (true)
 	{
-		return { static_cast<int>(e), connector_error_category() };
+		const auto frame = m_decoder.next(serial_number);
+		if (not frame or not frame->empty())
+		{
+			m_in_sync = frame.has_value() or not m_decoder.rejected_frame().empty();
+			return frame;
+		}
+
+		const auto free_space = m_decoder.prepare();
+
+		if constexpr (tcp_socket_concepts::receive_some<Socket>)
+		{
+			const auto received = socket.receive_some(free_space);
+			if (not received)
+			{
+				m_in_sync = false;
+				return std::unexpected{ received.error() };
+			}
+			m_decoder.commit(*received);
+		}
+		else
+		{
+			const auto missing = free_space.first(m_decoder.bytes_needed());
+			if (const auto error = socket.receive(missing))
+			{
+				m_in_sync = false;
+				return std::unexpected{ error };
+			}
+			m_decoder.commit(missing.size());
+		}
 	}
-} // namespace deye::connector_error
+}
 
+template<std::size_t Capacity>
+std::span<const std::uint8_t> deye::detail::frame_reader<Capacity>::rejected_frame() const
+{
+	return m_decoder.rejected_frame();
+}
 
-template <>
-struct std::is_error_code_enum<deye::connector_error::codes> : std::true_type {};
+template<std::size_t Capacity>
+bool deye::detail::frame_reader<Capacity>::in_sync() const
+{
+	return m_in_sync;
+}
 
+template<std::size_t Capacity>
+void deye::detail::frame_reader<Capacity>::clear()
+{
+	m_decoder.reset();
+	m_in_sync = true;
+}
 
-constexpr std::optional<deye::sensor_meta> deye::sensor_meta_by_id(config::sensor_id id)
+inline deye::detail::register_cache::register_cache()
 {
-	if (const auto index = static_cast<std::size_t>(id); index < config::sensors.size())
+	clear();
+}
+
+constexpr bool deye::detail::register_cache::covers(const register_range& range) const
+{
+	return
+		range.begin_address >= begin_address and
+		static_cast<std::size_t>(range.begin_address - begin_address) + range.register_count <= size;
+}
+
+inline bool deye::detail::register_cache::fresh(const std::size_t address, const clock::time_point expired_before) const
+{
+	return read_times[address - begin_address] >= expired_before;
+}
+
+inline void deye::detail::register_cache::store(
+	const std::uint16_t address,
+	std::span<const std::uint16_t> registers,
+	const clock::time_point read_time
+) {
+	std::ranges::copy(registers, values.begin() + (address - begin_address));
+	std::fill_n(read_times.begin() + (address - begin_address), registers.size(), read_time);
+}
+
+inline std::span<std::uint16_t> deye::detail::register_cache::view(const register_range& range)
+{
+	return std::span{ values }.subspan(range.begin_address - begin_address, range.register_count);
+}
+
+inline void deye::detail::register_cache::invalidate(const std::uint16_t address, const std::size_t register_count)
+{
+	// Clipped to the covered addresses, the written registers may start before or end after them.
+	const auto begin = std::max<std::size_t>(address, begin_address);
+	const auto end = std::min<std::size_t>(std::size_t{ address } + register_count, std::size_t{ begin_address } + size);
+	if (begin < end)
 	{
-		return config::sensors[index];
+		std::fill_n(read_times.begin() + (begin - begin_address), end - begin, clock::time_point::min());
 	}
-	else
+}
+
+inline void deye::detail::register_cache::clear()
+{
+	read_times.fill(clock::time_point::min());
+}
+
+inline void deye::detail::register_cache::rebase(const std::uint16_t address)
+{
+	begin_address = address;
+	clear();
+}
+
+template<class F>
+std::error_code deye::detail::modbus::decode_frame(std::span<std::uint8_t> message, F&& read_request)
+{
+	using connector_error::make_error_code;
+	using connector_error::codes;
+
+	if (message.size() < header_size + trailer_size)
 	{
-		return std::nullopt;
+		return make_error_code(codes::internal_error);
+	}
+
+	auto body = message.subspan(header_size);
+
+	if (body.size() == 18)
+	{
+		if (const auto code = bytes::to<std::uint16_t, std::endian::little>(body, 14))
+		{
+			codes errc;
+			switch (code.value())
+			{
+			case 0x0005:
+				errc = codes::device_address_mismatch;
+				break;
+			case 0x0006:
+				errc = codes::serial_number_mismatch;
+				break;
+			default:
+				errc = codes::unknown_response_code;
+				break;
+			}
+			return make_error_code(errc);
+		}
+		else
+		{
+			return code.error();
+		}
 	}
+
+	static constexpr auto ignore_end_byte = sizeof(std::uint8_t);
+	body = body.subspan(0, body.size() - ignore_end_byte);
+
+	if (body.size() < response_data_field_size + ignore_end_byte)
+	{
+		return make_error_code(codes::response_wrong_register_count);
+	}
+
+	return read_request({ body.begin() + response_data_field_size, body.end() - ignore_end_byte });
 }
 
-constexpr std::optional<deye::physical_unit> deye::physical_unit_by_id(config::physical_unit_id id)
-{
-	const auto index = static_cast<std::size_t>(id);
-	if (index < config::physical_units.size())
+inline std::error_code deye::detail::modbus::encode_read_request(
+	std::span<std::uint8_t> request,
+	const std::uint16_t begin_address,
+	const std::uint16_t register_count
+) {
+	if (request.size() != read_request_size)
 	{
-		return config::physical_units[index];
+		return make_error_code(connector_error::codes::internal_error);
 	}
-	else
+
+	auto offset = std::size_t{};
+	if (std::error_code error;
+		((error = bytes::from<std::uint16_t, std::endian::big>(0x0103	, request, &offset))) or
+		((error = bytes::from<std::uint16_t, std::endian::big>(begin_address	, request, &offset))) or
+		((error = bytes::from<std::uint16_t, std::endian::big>(register_count, request, &offset)))
+	) {
+		return error;
+	}
+
+	return {};
+}
+
+inline std::expected<std::span<std::uint16_t>, std::error_code> deye::detail::modbus::decode_read_response(
+	std::span<std::uint8_t> response,
+	const std::uint16_t register_count
+) {
+	using connector_error::make_error_code;
+
+	static constexpr auto ignore_crc_bytes = sizeof(std::uint16_t);
+	if (response.size() < ignore_crc_bytes)
 	{
-		return std::nullopt;
+		return std::unexpected{ make_error_code(connector_error::codes::response_wrong_register_count) };
+	}
+
+	const auto data = response.subspan(0, response.size() - ignore_crc_bytes);
+
+	const auto returned_register_byte_count = bytes::to<std::uint8_t, std::endian::big>(data, 2);
+	if (not returned_register_byte_count)
+	{
+		return std::unexpected{ returned_register_byte_count.error() };
+	}
+
+	if (returned_register_byte_count.value() / sizeof(std::uint16_t) != register_count)
+	{
+		return std::unexpected{ make_error_code(connector_error::codes::response_wrong_register_count) };
+	}
+
+	static constexpr auto register_offset = 3 * sizeof(std::uint8_t);
+
+	if (data.size() < register_offset + register_count * sizeof(std::uint16_t))
+	{
+		return std::unexpected{ make_error_code(connector_error::codes::response_wrong_register_count) };
 	}
+
+	const auto registers = std::span{
+		reinterpret_cast<std::uint16_t*>(data.data() + register_offset),
+		register_count
+	};
+
+	byteswap_registers(registers);
+
+	return registers;
 }
 
-constexpr std::optional<deye::enumeration> deye::enumeration_by_id(config::enumeration_id id)
+inline void deye::detail::modbus::byteswap_registers(std::span<std::uint16_t> registers)
 {
-	const auto index = static_cast<std::size_t>(id);
-	if (index < config::enumerations.size())
+	if constexpr (std::endian::native == std::endian::big)
 	{
-		return enumeration{ .names = config::enumerations[index] };
+		return;
 	}
-	else
+
+	auto it = registers.data();
+	const auto end = it + registers.size();
+
+#if defined(__GNUC__)
+	// Swapping the bytes of every 16-bit lane is a shift in both directions.
+	// Responses start at an odd offset, so the lanes are loaded and stored unaligned.
+	using lanes = std::uint16_t __attribute__((vector_size(16)));
+	static constexpr auto lane_count = sizeof(lanes) / sizeof(std::uint16_t);
+
+	for (; end - it >= static_cast<std::ptrdiff_t>(lane_count); it += lane_count)
 	{
-		return std::nullopt;
+		lanes block;
+		std::memcpy(&block, it, sizeof(lanes));
+		block = (block << 8) | (block >> 8);
+		std::memcpy(it, &block, sizeof(lanes));
+	}
+#endif
+
+	for (; it != end; ++it)
+	{
+		*it = std::byteswap(*it);
+	}
+}
+
+inline std::error_code deye::detail::modbus::encode_write_request(
+	std::span<std::uint8_t> request,
+	const std::uint16_t begin_address,
+	std::span<const std::uint16_t> values
+) {
+	using connector_error::make_error_code;
+
+	if (values.size() > max_write_register_count)
+	{
+		return make_error_code(connector_error::codes::too_many_register_values);
+	}
+
+	if (request.size() != write_request_size(values.size()))
+	{
+		return make_error_code(connector_error::codes::internal_error);
+	}
+
+	auto offset = std::size_t{};
+	if (std::error_code error;
+		((error = bytes::from<std::uint16_t, std::endian::big>(0x0110				, request, &offset))) or
+		((error = bytes::from<std::uint16_t, std::endian::big>(begin_address		, request, &offset))) or
+		((error = bytes::from<std::uint16_t, std::endian::big>(values.size()		, request, &offset))) or
+		((error = bytes::from<std::uint8_t , std::endian::big>(values.size_bytes()	, request, &offset))) or
+		((error = bytes::from<std::uint16_t, std::endian::big>(values				, request, &offset)))
+	) {
+		return error;
+	}
+
+	return {};
+}
+
+inline std::error_code deye::detail::modbus::decode_write_response(
+	std::span<const std::uint8_t> response,
+	const std::uint16_t begin_address,
+	const std::size_t register_count
+) {
+	using connector_error::make_error_code;
+
+	const auto returned_address = bytes::to<std::uint16_t, std::endian::big>(response, 2);
+	if (not returned_address)
+	{
+		return returned_address.error();
+	}
+
+	if (*returned_address != begin_address)
+	{
+		return make_error_code(connector_error::codes::response_wrong_address);
+	}
+
+	const auto returned_count = bytes::to<std::uint16_t, std::endian::big>(response, 4);
+	if (not returned_count)
+	{
+		return returned_count.error();
 	}
+
+	if (*returned_count != register_count)
+	{
+		return make_error_code(connector_error::codes::response_wrong_register_count);
+	}
+
+	return {};
 }
 
 
-//--------------[ byte util implementation ]--------------//
+//--------------[ read planner implementation ]--------------//
 
-constexpr std::uint8_t deye::detail::modbus::checksum(std::span<const std::uint8_t> data)
+namespace deye::detail::read_planner
 {
-	return std::accumulate(data.begin(), data.end(), std::uint8_t{});
-}
 
-constexpr std::uint16_t deye::detail::modbus::crc(std::span<const std::uint8_t> data)
-{
-	std::uint16_t crc = 0xFFFF;
+/**
+ * @brief Marks the requested sensors in a mask indexed like `sensors`.
+ *
+ * @return The mask or `connector_error::codes::unknown_sensor` for invalid ids.
+ */
+[[nodiscard]] inline std::expected<std::bitset<max_sensor_table_size>, std::error_code> requested_sensors(
+	std::span<const sensor_meta> sensors,
+	std::span<const config::sensor_id> sensor_ids
+) {
+	auto requested = std::bitset<max_sensor_table_size>{};
 
-	for (const auto& byte : data)
+	for (const auto& sensor_id : sensor_ids)
 	{
-		crc ^= static_cast<std::uint16_t>(byte);
-
-		for (int i = 0; i != 8; ++i)
+		if (const auto index = static_cast<std::size_t>(sensor_id); index < sensors.size() and index < requested.size())
 		{
-			if ((crc & 0x0001) != 0) {
-				crc >>= 1;
-				crc ^= 0xA001;
-			} else {
-				crc >>= 1;
-			}
+			requested[index] = true;
+		}
+		else
+		{
+			return std::unexpected{ make_error_code(connector_error::codes::unknown_sensor) };
 		}
 	}
 
-	return crc;
+	return requested;
 }
 
-
-template<typename T, std::endian Endian>
-std::error_code deye::detail::bytes::from(
-	const auto& value, std::span<std::uint8_t> bytes,
-	std::size_t* offset
+/**
+ * @brief Decodes every sensor of `sensor_ids` that lies completely within `range` into `sensor_values`.
+ *
+ * @param registers The registers read for `range`.
+ */
+[[nodiscard]] inline std::error_code decode_range(
+	std::span<const sensor_meta> sensors,
+	std::span<const config::sensor_id> sensor_ids,
+	std::span<sensor_value> sensor_values,
+	const register_range& range,
+	std::span<const std::uint16_t> registers
 ) {
-	if constexpr (is_container<decltype(value), const T>::value)
+	const auto range_end = range.begin_address + range.register_count;
+
+	for (std::size_t i{}; i != sensor_ids.size(); ++i)
 	{
-		for (const auto &element : value)
+		const auto& sensor_meta = sensors[static_cast<std::size_t>(sensor_ids[i])];
+
+		if (
+			sensor_meta.begin_address < range.begin_address or
+			sensor_meta.begin_address + sensor_meta.register_count > range_end
+		) {
+			continue;
+		}
+
+		if (const auto value = sensor_meta.rep.interpret(
+			registers.subspan(
+				sensor_meta.begin_address - range.begin_address,
+				sensor_meta.register_count
+			)
+		)) {
+			sensor_values[i] = value.value();
+		}
+		else
 		{
-			if (const auto error = from<T, Endian>(element, bytes, offset))
-			{
-				return error;
-			}
+			return value.error();
 		}
 	}
-	else if (*offset >= bytes.size() or (bytes.size() - *offset) < sizeof(T))
+
+	return {};
+}
+
+} // namespace deye::detail::read_planner
+
+
+//--------------[ columnar decode implementation ]--------------//
+
+constexpr deye::detail::columns::transform deye::detail::columns::transform_of(const sensor_value_rep& rep)
+{
+	using enum sensor_value_rep_id;
+
+	constexpr auto no_unit = config::physical_unit_id::COUNT;
+
+	switch (rep.type())
 	{
-		return std::make_error_code(std::errc::result_out_of_range);
+	case integer:
+	{
+		const auto integer_rep = *rep.get<sensor_value_rep::integer>();
+		return { static_cast<double>(integer_rep.scale), static_cast<double>(integer_rep.offset), no_unit };
 	}
-	else
+	case physical:
 	{
-		auto t_value = static_cast<T>(value);
+		const auto physical_rep = *rep.get<sensor_value_rep::physical>();
+		return { physical_rep.scale, physical_rep.offset, physical_rep.unit_id };
+	}
+	case enumeration:
+		return { 1.0, 0.0, no_unit };
+	default:
+		// Raw registers have no numeric value.
+		return { 0.0, std::numeric_limits<double>::quiet_NaN(), no_unit };
+	}
+}
 
-		if constexpr (std::integral<T> and Endian != std::endian::native)
+inline std::error_code deye::detail::columns::gather_range(
+	std::span<const sensor_meta> sensors,
+	std::span<const config::sensor_id> sensor_ids,
+	std::span<double> raw_values,
+	const register_range& range,
+	std::span<const std::uint16_t> registers
+) {
+	const auto range_end = range.begin_address + range.register_count;
+
+	for (std::size_t i{}; i != sensor_ids.size(); ++i)
+	{
+		const auto& sensor_meta = sensors[static_cast<std::size_t>(sensor_ids[i])];
+
+		if (
+			sensor_meta.begin_address < range.begin_address or
+			sensor_meta.begin_address + sensor_meta.register_count > range_end
+		) {
+			continue;
+		}
+
+		if (sensor_meta.rep.type() == sensor_value_rep_id::registers)
 		{
-			t_value = std::byteswap(t_value);
+			raw_values[i] = 0.0;
+			continue;
 		}
 
-		std::memcpy(&bytes[*offset], &t_value, sizeof(T));
+		// Same layout as `sensor_value_rep::interpret`, the first register holds the low word.
+		auto integer_value = std::uint64_t{};
+		const auto sensor_registers = registers.subspan(sensor_meta.begin_address - range.begin_address, sensor_meta.register_count);
+		if (sensor_registers.size_bytes() > sizeof(integer_value))
+		{
+			return std::make_error_code(std::errc::result_out_of_range);
+		}
+		std::memcpy(&integer_value, sensor_registers.data(), sensor_registers.size_bytes());
 
-		*offset += sizeof(T);
+		raw_values[i] = static_cast<double>(static_cast<std::int64_t>(integer_value));
 	}
 
 	return {};
 }
 
-template<typename T, std::endian Endian>
-std::error_code deye::detail::bytes::from(
-	const auto& value,
-	std::span<std::uint8_t> bytes,
-	std::size_t offset
+inline void deye::detail::columns::scale_and_offset(
+	std::span<double> values,
+	std::span<const double> scales,
+	std::span<const double> offsets
 ) {
-	return from<T, Endian>(value, bytes, &offset);
-}
+	auto i = std::size_t{};
 
-template<typename T, std::endian Endian>
-std::expected<T, std::error_code> deye::detail::bytes::to(
-	std::span<const std::uint8_t> bytes,
-	std::size_t* offset
-) {
-	if (*offset >= bytes.size() or (bytes.size() - *offset) < sizeof(T))
+#if defined(__GNUC__)
+	using lanes = double __attribute__((vector_size(32)));
+	static constexpr auto lane_count = sizeof(lanes) / sizeof(double);
+
+	for (; values.size() - i >= lane_count; i += lane_count)
 	{
-		return std::unexpected{ std::make_error_code(std::errc::result_out_of_range) };
+		lanes value, scale, offset;
+		std::memcpy(&value, values.data() + i, sizeof(lanes));
+		std::memcpy(&scale, scales.data() + i, sizeof(lanes));
+		std::memcpy(&offset, offsets.data() + i, sizeof(lanes));
+		value = value * scale + offset;
+		std::memcpy(values.data() + i, &value, sizeof(lanes));
 	}
+#endif
 
-	T value;
-
-	std::memcpy(&value, &bytes[*offset], sizeof(T));
-
-	if constexpr (std::integral<T> and Endian != std::endian::native)
+	for (; i != values.size(); ++i)
 	{
-		value = std::byteswap(value);
+		values[i] = values[i] * scales[i] + offsets[i];
 	}
-
-	*offset += sizeof(T);
-
-	return value;
 }
 
-template<typename T, std::endian Endian>
-std::expected<T, std::error_code> deye::detail::bytes::to(
-	std::span<const std::uint8_t> bytes,
-	std::size_t offset
-) {
-	return to<T, Endian>(bytes, &offset);
-}
 
 template<deye::detail::tcp_socket Socket>
 deye::connector<Socket>::connector(serial_number_type serial_number) :
-	m_serial_number{ serial_number } {}
+	m_frame_template{ serial_number },
+	m_serial_number{ serial_number },
+	m_sensors{ config::sensors }
+{
+	set_timeouts(m_timeouts);
+}
 
 template<deye::detail::tcp_socket Socket>
 std::error_code deye::connector<Socket>::connect(const char* host, const std::uint16_t port)
 {
-	return m_socket.connect(host, port);
+	m_reader.clear();
+	m_cache.clear();
+	return detail::socket_error(m_socket.connect(host, port));
 }
 
 template<deye::detail::tcp_socket Socket>
 std::error_code deye::connector<Socket>::disconnect()
 {
+	m_reader.clear();
 	return m_socket.disconnect();
 }
 
@@ -746,225 +2757,367 @@ const deye::serial_number_type& deye::connector<Socket>::serial_number() const
 }
 
 template<deye::detail::tcp_socket Socket>
-template<class F>
-std::error_code deye::connector<Socket>::send_modbus_frame(std::size_t data_size, F&& write_request)
+deye::read_plan_config& deye::connector<Socket>::read_plan()
 {
-	using connector_error::make_error_code;
-	using connector_error::codes;
+	return m_read_plan;
+}
 
-	const auto payload_size = (
-		15			+			// data field
-		data_size	+			// data
-		sizeof(std::uint16_t) 	// crc
-	);
+template<deye::detail::tcp_socket Socket>
+const deye::read_plan_config& deye::connector<Socket>::read_plan() const
+{
+	return m_read_plan;
+}
 
-	const auto frame_size = (
-		sizeof(std::uint8_t)	+	// start byte
-		sizeof(std::uint16_t)	+	// payload length
-		sizeof(std::uint16_t)	+	// control code
-		sizeof(std::uint16_t)	+	// inverter serial number prefix
-		sizeof(serial_number_type)	+	// serial number
-		payload_size 			+	// payload
-		sizeof(std::uint8_t)	+	// checksum
-		sizeof(std::uint8_t)		// end byte
-	);
+template<deye::detail::tcp_socket Socket>
+void deye::connector<Socket>::set_timeouts(const timeout_config& timeouts)
+{
+	m_timeouts = timeouts;
+	m_socket.set_timeouts(m_timeouts.connect, m_timeouts.send, m_timeouts.receive);
+}
 
-	if (frame_size > m_buffer.size())
-	{
-		return make_error_code(codes::action_exceeds_local_buffer_size);
-	}
+template<deye::detail::tcp_socket Socket>
+const deye::timeout_config& deye::connector<Socket>::timeouts() const
+{
+	return m_timeouts;
+}
 
-	auto frame = std::span{ m_buffer.data(), frame_size };
+template<deye::detail::tcp_socket Socket>
+void deye::connector<Socket>::set_cache_ttl(const std::chrono::milliseconds ttl)
+{
+	m_cache_ttl = ttl;
+}
 
-	auto offset = std::size_t{};
+template<deye::detail::tcp_socket Socket>
+std::chrono::milliseconds deye::connector<Socket>::cache_ttl() const
+{
+	return m_cache_ttl;
+}
 
-	namespace bytes = detail::bytes;
+template<deye::detail::tcp_socket Socket>
+void deye::connector<Socket>::clear_cache()
+{
+	m_cache.clear();
+}
 
-	if (std::error_code error;
-		((error = bytes::from<std::uint8_t	    , std::endian::little>(0xa5			, frame, &offset))) or // start byte
-		((error = bytes::from<std::uint16_t	    , std::endian::little>(payload_size		, frame, &offset))) or // payload size
-		((error = bytes::from<std::uint16_t	    , std::endian::little>(0x4510		, frame, &offset))) or // control code
-		((error = bytes::from<std::uint16_t		, std::endian::little>(0x0000		, frame, &offset))) or // inverter_sn_prefix
-		((error = bytes::from<serial_number_type, std::endian::little>(m_serial_number	, frame, &offset))) or // serial number
-		((error = bytes::from<std::uint8_t		, std::endian::little>(0x2			, frame, &offset))) or // data field
-		((error = bytes::from<std::uint16_t		, std::endian::little>(0x00			, frame, &offset))) or // "
-		((error = bytes::from<std::uint32_t		, std::endian::little>(0x0000		, frame, &offset))) or // "
-		((error = bytes::from<std::uint64_t		, std::endian::little>(0x00000000	, frame, &offset))) 	// "
+template<deye::detail::tcp_socket Socket>
+std::error_code deye::connector<Socket>::set_sensors(const std::span<const sensor_meta> sensors)
+{
+	if (
+		sensors.size() > max_sensor_table_size or
+		not std::ranges::is_sorted(sensors, {}, &sensor_meta::begin_address)
 	) {
-		return error;
+		return connector_error::make_error_code(connector_error::codes::invalid_profile);
 	}
 
-	auto data = frame.subspan(offset, data_size);
-	if (const auto error = write_request(data))
+	m_sensors = sensors;
+	m_cache.rebase(sensors.empty() ? std::uint16_t{} : sensors.front().begin_address);
+
+	return {};
+}
+
+template<deye::detail::tcp_socket Socket>
+std::span<const deye::sensor_meta> deye::connector<Socket>::sensors() const
+{
+	return m_sensors;
+}
+
+template<deye::detail::tcp_socket Socket>
+template<class F>
+std::expected<std::uint8_t, std::error_code> deye::connector<Socket>::send_modbus_frame(
+	std::size_t data_size,
+	F&& write_request
+) {
+	const auto sequence_number = ++m_sequence_number;
+
+	const auto frame = current_frame_template().encode(
+		m_buffer,
+		sequence_number,
+		data_size,
+		std::forward<F>(write_request)
+	);
+
+	if (not frame)
 	{
-		return error;
+		return std::unexpected{ frame.error() };
 	}
 
-	offset += data_size;
+	if (const auto error = m_socket.send(*frame))
+	{
+		return std::unexpected{ detail::socket_error(error) };
+	}
+
+	return sequence_number;
+}
+
+template<deye::detail::tcp_socket Socket>
+std::expected<std::uint8_t, std::error_code> deye::connector<Socket>::send_read_request(const register_range& range)
+{
+	return send_modbus_frame(
+		detail::modbus::read_request_size,
+		[&](std::span<std::uint8_t> request) -> std::error_code
+		{
+			return detail::modbus::encode_read_request(request, range.begin_address, range.register_count);
+		}
+	);
+}
 
-	const auto crc = detail::modbus::crc(data);
-	if (const auto error = bytes::from<std::uint16_t, std::endian::little>(crc, frame, &offset))
+template<deye::detail::tcp_socket Socket>
+const deye::detail::modbus::frame_template& deye::connector<Socket>::current_frame_template()
+{
+	if (m_frame_template.serial_number() != m_serial_number)
 	{
-		return error;
+		m_frame_template = detail::modbus::frame_template{ m_serial_number };
 	}
 
-	static constexpr auto ignore_start_byte = sizeof(std::uint8_t);
-	const auto checksum = detail::modbus::checksum(frame.subspan(ignore_start_byte, offset - ignore_start_byte));
+	return m_frame_template;
+}
 
-	if (std::error_code error;
-	    ((error = bytes::from<std::uint8_t , std::endian::little>(checksum,	frame, &offset))) or // checksum placeholder
-	    ((error = bytes::from<std::uint8_t , std::endian::little>(0x15,	frame, &offset)))	  // end byte
+template<deye::detail::tcp_socket Socket>
+template<class P, class F>
+std::error_code deye::connector<Socket>::receive_modbus_frame(P&& is_awaited, F&& read_request)
+{
+	while (true)
+	{
+		const auto message = m_reader.next_frame(m_socket, m_serial_number);
+		if (not message)
+		{
+			// A rejected frame still answers its request, which must not be waited for again.
+			const auto rejected = m_reader.rejected_frame();
+			if (rejected.empty() or is_awaited(detail::modbus::header_sequence_number(rejected)))
+			{
+				return detail::socket_error(message.error());
+			}
+			continue;
+		}
+
+		const auto sequence_number = detail::modbus::header_sequence_number(*message);
+
+		if (is_awaited(sequence_number))
+		{
+			return detail::modbus::decode_frame(*message, [&](std::span<std::uint8_t> response)
+			{
+				return read_request(sequence_number, response);
+			});
+		}
+	}
+}
+
+template<deye::detail::tcp_socket Socket>
+std::error_code deye::connector<Socket>::discard_responses(std::size_t count, const std::error_code error)
+{
+	// After transport errors the responses won't arrive and waiting for them would only add timeouts.
+	if (
+		error.category() != connector_error_category() or
+		error == connector_error::make_error_code(connector_error::codes::operation_timed_out)
 	) {
 		return error;
 	}
 
+	// Rejected frames count as drained, framing errors leave no frame boundary to resume from.
+	for (; count != 0 and m_reader.in_sync(); --count)
+	{
+		// Whatever this leaves in the stream is dropped by its sequence number later on.
+		[[maybe_unused]] const auto frame = m_reader.next_frame(m_socket, m_serial_number);
+	}
 
-	return m_socket.send(frame);
+	return error;
 }
 
+
 template<deye::detail::tcp_socket Socket>
-template<class F>
-std::error_code deye::connector<Socket>::receive_modbus_frame(F&& read_request)
+template<class F, class G>
+std::error_code deye::connector<Socket>::modbus_request(std::size_t data_size, F&& write_request, G&& read_request)
 {
+	const auto sent_sequence_number = send_modbus_frame(data_size, std::forward<F>(write_request));
+	if (not sent_sequence_number)
+	{
+		return sent_sequence_number.error();
+	}
+
+	return receive_modbus_frame(
+		[&](const std::uint8_t sequence_number) { return sequence_number == *sent_sequence_number; },
+		[&](std::uint8_t, std::span<std::uint8_t> response) { return read_request(response); }
+	);
+}
+
+template<deye::detail::tcp_socket Socket>
+template<class F>
+std::error_code deye::connector<Socket>::read_register_ranges(
+	std::span<const register_range> ranges,
+	const std::uint8_t max_frames_in_flight,
+	F&& on_registers
+) {
 	using connector_error::make_error_code;
 	using connector_error::codes;
 
-	//-------------[ receive header ]-------------//
+	// Requests of cached ranges only cover the expired part of their range.
+	struct pending_request
+	{
+		std::uint8_t sequence_number;
+		std::size_t range_index;
+		register_range request;
+	};
 
-	constexpr auto header_size = (
-		sizeof(std::uint8_t)  		+ // start byte
-		sizeof(std::uint16_t) 		+ // data length
-		sizeof(std::uint16_t) 		+ // control code
-		sizeof(std::uint16_t) 		+ // inverter serial number prefix
-		sizeof(serial_number_type)	  // serial number
-	);
+	auto pending = std::array<pending_request, max_pipeline_depth>{};
+	auto pending_count = std::size_t{};
 
-	static_assert(header_size < m_buffer.size());
+	const auto pipeline_depth = std::clamp<std::size_t>(max_frames_in_flight, 1, max_pipeline_depth);
 
-	const auto header = std::span{ m_buffer.data(), header_size };
+	// Fixed for the whole call, so cached registers can't expire while the rest of their range is pending.
+	const auto expired_before = detail::register_cache::clock::now() - m_cache_ttl;
 
-	if (const auto error = m_socket.receive(header))
+	const auto cached = [&](const register_range& range)
 	{
-		return error;
-	}
-
-	//-------------[ check header ]-------------//
+		return m_cache_ttl != std::chrono::milliseconds::zero() and m_cache.covers(range);
+	};
 
-	if (header.front() != 0xa5)
+	const auto is_pending = [&](const std::size_t range_index)
 	{
-		return make_error_code(codes::response_invalid_start);
-	}
+		return std::any_of(
+			pending.begin(), pending.begin() + pending_count,
+			[&](const pending_request& request) { return request.range_index == range_index; }
+		);
+	};
 
-	namespace bytes = detail::bytes;
+	const auto deliver_from_cache = [&](const std::size_t range_index) -> std::error_code
+	{
+		return on_registers(range_index, m_cache.view(ranges[range_index]));
+	};
 
+	auto next_range = std::size_t{};
+	auto next_address = ranges.empty() ? std::size_t{} : ranges.front().begin_address;
 
-	if (const auto returned_serial_number = bytes::to<serial_number_type, std::endian::little>(header, 7))
+	while (next_range != ranges.size() or pending_count != 0)
 	{
-		if (returned_serial_number.value() != m_serial_number)
+		// Top up the pipeline before blocking on the oldest response.
+		while (next_range != ranges.size() and pending_count != pipeline_depth)
 		{
-			// TODO this will lose precision on 32 bits and smaller machines.
-			return { static_cast<int>(returned_serial_number.value()), connector_error_category() };
-		}
-	}
+			const auto& range = ranges[next_range];
+			const auto range_end = static_cast<std::size_t>(range.begin_address) + range.register_count;
 
-	const auto data_size = bytes::to<std::uint16_t, std::endian::little>(header, 1);
-	if (not data_size)
-	{
-		return data_size.error();
-	}
+			auto request = register_range{};
 
-	//-------------[ receive body ]-------------//
+			if (cached(range))
+			{
+				// Find the next run of expired registers, fresh gaps up to the round trip cost are read along.
+				auto begin = next_address;
+				while (begin != range_end and m_cache.fresh(begin, expired_before))
+				{
+					++begin;
+				}
+
+				auto end = begin;
+				for (auto address = begin; address != range_end and address - end <= m_read_plan.round_trip_cost; ++address)
+				{
+					if (not m_cache.fresh(address, expired_before))
+					{
+						end = address + 1;
+					}
+				}
 
-	const auto body_size = (
-		*data_size				+ // payload
-		sizeof(std::uint8_t)	+ // checksum
-		sizeof(std::uint8_t)	  // end byte
-	);
+				request = { static_cast<std::uint16_t>(begin), static_cast<std::uint16_t>(end - begin) };
+				next_address = end == begin ? range_end : end;
+			}
+			else
+			{
+				request = range;
+				next_address = range_end;
+			}
 
-	const auto full_size = header_size + body_size;
-	if (full_size > m_buffer.size())
-	{
-		return make_error_code(codes::action_exceeds_local_buffer_size);
-	}
+			if (request.register_count != 0)
+			{
+				const auto sequence_number = send_read_request(request);
 
-	const auto message = std::span{ m_buffer.data(), full_size };
-	auto body = message.subspan(header_size);
+				if (not sequence_number)
+				{
+					return discard_responses(pending_count, sequence_number.error());
+				}
+
+				pending[pending_count++] = { *sequence_number, next_range, request };
+			}
+
+			if (next_address == range_end)
+			{
+				// Ranges whose requests already completed, or that didn't need any, are served from the cache.
+				if (not is_pending(next_range))
+				{
+					if (const auto error = deliver_from_cache(next_range))
+					{
+						return discard_responses(pending_count, error);
+					}
+				}
+
+				if (++next_range != ranges.size())
+				{
+					next_address = ranges[next_range].begin_address;
+				}
+			}
+		}
+
+		if (pending_count == 0)
+		{
+			continue;
+		}
 
-	if (const auto error = m_socket.receive(body))
-	{
-		return error;
-	}
+		// The request is completed before its frame is decoded, so error responses complete their request as well.
+		auto received = pending_request{};
 
-	//-------------[ check body ]-------------//
+		const auto error = receive_modbus_frame(
+			[&](const std::uint8_t sequence_number)
+			{
+				const auto it = std::find_if(
+					pending.begin(), pending.begin() + pending_count,
+					[&](const pending_request& request) { return request.sequence_number == sequence_number; }
+				);
 
-	 if (body.size() == 18)
-	 {
-	 	if (const auto code = bytes::to<std::uint16_t, std::endian::little>(body, 14))
-	 	{
-	 		codes errc;
-	 		switch (code.value())
-	 		{
-	 		case 0x0005:
-	 			errc = codes::device_address_mismatch;
-	 			break;
-	 		case 0x0006:
-	 			errc = codes::serial_number_mismatch;
-	 			break;
-	 		default:
-	 			errc = codes::unknown_response_code;
-	 			break;
-	 		}
-	 		return make_error_code(errc);
-	 	}
-	 	else
-	 	{
-	 		return code.error();
-	 	}
-	}
+				if (it == pending.begin() + pending_count)
+				{
+					return false;
+				}
 
-	if (body.back() != 0x15)
-	{
-		return make_error_code(codes::response_invalid_end);
-	}
+				received = *it;
+				*it = pending[--pending_count];
 
-	static constexpr auto ignore_end_byte = sizeof(std::uint8_t);
-	body = body.subspan(0, body.size() - ignore_end_byte);
+				return true;
+			},
+			[&](std::uint8_t, std::span<std::uint8_t> res) -> std::error_code
+			{
+				const auto [ _, range_index, request ] = received;
 
-	static constexpr auto ignore_end_bytes = 2 * sizeof(std::uint8_t);
+				const auto registers = detail::modbus::decode_read_response(res, request.register_count);
+				if (not registers)
+				{
+					return registers.error();
+				}
 
-#ifdef DEYE_REDUNDANT_ERROR_CHECKS
-	const auto expected_checksum = body.back();
+				const auto& range = ranges[range_index];
 
-	static constexpr auto ignore_start_byte = sizeof(std::uint8_t);
-	const auto actual_checksum = detail::modbus::checksum(
-		message.subspan(
-			ignore_start_byte,
-			message.size() - ignore_start_byte - ignore_end_bytes
-		)
-	);
+				if (not cached(range))
+				{
+					return on_registers(range_index, *registers);
+				}
 
-	if (expected_checksum != actual_checksum)
-	{
-		return make_error_code(codes::response_wrong_checksum);
-	}
-#endif
+				m_cache.store(request.begin_address, *registers, detail::register_cache::clock::now());
 
-	return read_request({ body.begin() + 14, body.end() - ignore_end_byte });
-}
+				// The range is complete once it has been scanned and its last request arrived.
+				if (range_index >= next_range or is_pending(range_index))
+				{
+					return {};
+				}
 
+				if (request.begin_address == range.begin_address and request.register_count == range.register_count)
+				{
+					return on_registers(range_index, *registers);
+				}
 
-template<deye::detail::tcp_socket Socket>
-template<class F, class G>
-std::error_code deye::connector<Socket>::modbus_request(std::size_t data_size, F&& write_request, G&& read_request)
-{
-	if (const auto error = send_modbus_frame(data_size, std::forward<F>(write_request)))
-	{
-		return error;
-	}
+				return deliver_from_cache(range_index);
+			}
+		);
 
-	if (const auto error = receive_modbus_frame(std::forward<G>(read_request)))
-	{
-		return error;
+		if (error)
+		{
+			return discard_responses(pending_count, error);
+		}
 	}
 
 	return {};
@@ -975,282 +3128,415 @@ std::expected<std::span<std::uint16_t>, std::error_code> deye::connector<Socket>
 	const std::uint16_t begin_address,
 	const std::uint16_t register_count
 ) {
-	using connector_error::make_error_code;
-
-	constexpr auto request_size = (
-		sizeof(std::uint16_t) + // request type
-		sizeof(std::uint16_t) + // begin address
-		sizeof(std::uint16_t)   // register count
-	);
-
 	auto register_view = std::span<std::uint16_t>{};
 
-	namespace bytes = detail::bytes;
+	const auto range = register_range{ begin_address, register_count };
 
-	const auto write_request = [&](std::span<std::uint8_t> req) -> std::error_code
-	{
-		if (req.size() != request_size)
+	// The registers are either decoded in place in the frame buffer or copied out of the cache,
+	// both stay valid until the next request.
+	if (const auto error = read_register_ranges(
+		std::span{ &range, 1 },
+		1,
+		[&](std::size_t, std::span<std::uint16_t> registers) -> std::error_code
 		{
-			return make_error_code(connector_error::codes::internal_error);
+			register_view = registers;
+			return {};
 		}
+	)) {
+		return std::unexpected{ error };
+	}
 
-		auto offset = std::size_t{};
-		if (std::error_code error;
-			((error = bytes::from<std::uint16_t, std::endian::big>(0x0103	, req, &offset))) or
-			((error = bytes::from<std::uint16_t, std::endian::big>(begin_address	, req, &offset))) or
-			((error = bytes::from<std::uint16_t, std::endian::big>(register_count, req, &offset)))
-		) {
-			return error;
-		}
+	return register_view;
+}
 
-		return {};
+template<deye::detail::tcp_socket Socket>
+std::error_code deye::connector<Socket>::write_registers(std::uint16_t begin_address, std::span<const std::uint16_t> values)
+{
+	if (values.size() > detail::modbus::max_write_register_count)
+	{
+		return connector_error::make_error_code(connector_error::codes::too_many_register_values);
+	}
+
+	const auto write_request = [&](std::span<std::uint8_t> req) -> std::error_code
+	{
+		return detail::modbus::encode_write_request(req, begin_address, values);
 	};
 
 	const auto read_request = [&](std::span<std::uint8_t> res) -> std::error_code
 	{
-		static constexpr auto ignore_crc_bytes = sizeof(std::uint16_t);
-		const auto data = res.subspan(0, res.size() - ignore_crc_bytes);
+		return detail::modbus::decode_write_response(res, begin_address, values.size());
+	};
 
-#ifdef DEYE_REDUNDANT_ERROR_CHECKS
-		const auto expected_crc = detail::modbus::crc(data);
+	// Even a failed write may have changed some of the registers.
+	m_cache.invalidate(begin_address, values.size());
 
-		if (const auto actual_crc = bytes::to<std::uint16_t, std::endian::little>(res, data.size()))
-		{
-			if (actual_crc.value() != expected_crc)
+	return modbus_request(detail::modbus::write_request_size(values.size()), write_request, read_request);
+}
+
+template<deye::detail::tcp_socket Socket>
+[[nodiscard]] std::expected<deye::sensor_value, std::error_code> deye::connector<Socket>::read_sensor(
+	const config::sensor_id id
+) {
+	using connector_error::make_error_code;
+
+	if (const auto index = static_cast<std::size_t>(id); index < m_sensors.size())
+	{
+		const auto sensor_meta = &m_sensors[index];
+
+		if (const auto registers = read_registers(
+			sensor_meta->begin_address, sensor_meta->register_count
+		)) {
+			if (const auto value = sensor_meta->rep.interpret(registers.value()))
+			{
+				return value.value();
+			}
+			else
 			{
-				return make_error_code(connector_error::codes::response_wrong_crc);
+				return std::unexpected{ value.error() };
 			}
 		}
 		else
 		{
-			return actual_crc.error();
+			return std::unexpected{ registers.error() };
 		}
-#endif
+	}
+	else
+	{
+		return std::unexpected{ make_error_code(connector_error::codes::unknown_sensor) };
+	}
+}
 
-		const auto returned_register_byte_count = detail::bytes::to<std::uint8_t, std::endian::big>(data, 2);
-		if (not returned_register_byte_count)
-		{
-			return returned_register_byte_count.error();
-		}
+template<deye::detail::tcp_socket Socket>
+template<class F>
+std::error_code deye::connector<Socket>::read_planned_ranges(
+	std::span<const config::sensor_id> sensor_ids,
+	F&& on_registers
+) {
+	const auto requested = detail::read_planner::requested_sensors(m_sensors, sensor_ids);
+	if (not requested)
+	{
+		return requested.error();
+	}
 
-		if (returned_register_byte_count.value() / sizeof(std::uint16_t) != register_count)
+	// Every range contains at least one sensor, so there can't be more ranges than sensors.
+	auto ranges = std::array<register_range, max_sensor_table_size>{};
+	auto range_count = std::size_t{};
+
+	if (const auto error = detail::read_planner::for_each_range(
+		m_sensors,
+		[&](const std::size_t index) { return (*requested)[index]; },
+		m_read_plan,
+		[&](const register_range& range) -> std::error_code
 		{
-			return make_error_code(connector_error::codes::response_wrong_register_count);
+			ranges[range_count++] = range;
+			return {};
 		}
+	)) {
+		return error;
+	}
 
-		static constexpr auto register_offset = 3 * sizeof(std::uint8_t);
-
-		if (data.size() < register_offset + register_count * sizeof(std::uint16_t))
+	return read_register_ranges(
+		std::span{ ranges.data(), range_count },
+		m_read_plan.max_frames_in_flight,
+		[&](const std::size_t range_index, std::span<const std::uint16_t> registers)
 		{
-			return make_error_code(connector_error::codes::response_wrong_register_count);
+			return on_registers(ranges[range_index], registers);
 		}
+	);
+}
 
-		register_view = {
-			reinterpret_cast<std::uint16_t*>(data.data() + register_offset),
-			register_count
-		};
-
-		return {};
-	};
+template<deye::detail::tcp_socket Socket>
+std::error_code deye::connector<Socket>::read_sensors(
+	std::span<const config::sensor_id> sensor_ids,
+	std::span<sensor_value> sensor_values
+) {
+	using connector_error::make_error_code;
 
-	if (const auto error = modbus_request(request_size, write_request, read_request))
+	if (sensor_ids.size() != sensor_values.size())
 	{
-		return std::unexpected{ error };
+		return make_error_code(connector_error::codes::num_sensors_values_mismatch);
 	}
 
-	if constexpr (std::endian::native != std::endian::big)
+	if (sensor_ids.empty())
 	{
-		for (auto& reg : register_view)
-		{
-			reg = std::byteswap(reg);
-		}
+		return {};
 	}
 
-	return register_view;
+	return read_planned_ranges(
+		sensor_ids,
+		[&](const register_range& range, std::span<const std::uint16_t> registers)
+		{
+			return detail::read_planner::decode_range(m_sensors, sensor_ids, sensor_values, range, registers);
+		}
+	);
 }
 
 template<deye::detail::tcp_socket Socket>
-std::error_code deye::connector<Socket>::write_registers(std::uint16_t begin_address, std::span<const std::uint16_t> values)
-{
+std::error_code deye::connector<Socket>::read_sensors(
+	std::span<const config::sensor_id> sensor_ids,
+	const sensor_columns columns
+) {
 	using connector_error::make_error_code;
-	using connector_error::codes;;
 
-	if (values.size_bytes() > std::numeric_limits<std::uint8_t>::max())
+	if (sensor_ids.size() != columns.values.size() or sensor_ids.size() != columns.unit_ids.size())
 	{
-		return make_error_code(codes::too_many_register_values);
+		return make_error_code(connector_error::codes::num_sensors_values_mismatch);
 	}
 
-	const auto request_size = (
-		sizeof(std::uint16_t) +	// start bytes
-		sizeof(std::uint16_t) +	// begin address
-		sizeof(std::uint16_t) +	// address count
-		sizeof(std::uint8_t) +	// byte count
-		values.size_bytes()
-	);
-
-	namespace bytes = detail::bytes;
-
-	const auto write_request = [&](std::span<std::uint8_t> req) -> std::error_code
+	if (sensor_ids.empty())
 	{
-		if (req.size() != request_size)
+		return {};
+	}
+
+	if (const auto error = read_planned_ranges(
+		sensor_ids,
+		[&](const register_range& range, std::span<const std::uint16_t> registers)
 		{
-			return make_error_code(codes::internal_error);
+			return detail::columns::gather_range(m_sensors, sensor_ids, columns.values, range, registers);
 		}
+	)) {
+		return error;
+	}
 
-		auto offset = std::size_t{};
-		if (
-			std::error_code error;
-			((error = bytes::from<std::uint16_t, std::endian::big>(0x1001			    , req, &offset))) or
-			((error = bytes::from<std::uint16_t, std::endian::big>(begin_address	    		, req, &offset))) or
-			((error = bytes::from<std::uint16_t, std::endian::big>(values.size()	    , req, &offset))) or
-			((error = bytes::from<std::uint8_t , std::endian::big>(values.size_bytes()	, req, &offset))) or
-			((error = bytes::from<std::uint16_t, std::endian::big>(values					, req, &offset)))
-		) {
-			return error;
-		}
+	// The transforms are laid out in blocks so the kernel streams over contiguous arrays.
+	static constexpr auto block_size = std::size_t{ 64 };
 
-		return {};
-	};
+	auto scales = std::array<double, block_size>{};
+	auto offsets = std::array<double, block_size>{};
 
-	const auto read_request = [&](std::span<std::uint8_t> res)
+	for (std::size_t begin{}; begin < sensor_ids.size(); begin += block_size)
 	{
-#ifdef DEYE_REDUNDANT_ERROR_CHECKS
-		static constexpr auto ignore_crc_bytes = sizeof(std::uint16_t);
-		const auto data = res.subspan(0, res.size() - ignore_crc_bytes);
-		const auto expected_crc = detail::modbus::crc(data);
+		const auto count = std::min(block_size, sensor_ids.size() - begin);
 
-		if (const auto actual_crc = bytes::to<std::uint16_t, std::endian::little>(res, data.size()))
-		{
-			if (actual_crc != expected_crc)
-			{
-				return make_error_code(codes::response_wrong_crc);
-			}
-		}
-		else
+		for (std::size_t i{}; i != count; ++i)
 		{
-			return actual_crc.error();
+			const auto transform = detail::columns::transform_of(
+				m_sensors[static_cast<std::size_t>(sensor_ids[begin + i])].rep
+			);
+			scales[i] = transform.scale;
+			offsets[i] = transform.offset;
+			columns.unit_ids[begin + i] = transform.unit_id;
 		}
-#endif
 
-		if (const auto returned_address = bytes::to<std::uint16_t, std::endian::big>(res, 2))
+		detail::columns::scale_and_offset(
+			columns.values.subspan(begin, count),
+			std::span{ scales }.first(count),
+			std::span{ offsets }.first(count)
+		);
+	}
+
+	return {};
+}
+
+template<deye::detail::tcp_socket Socket>
+template<auto SensorIds, deye::read_plan_config Config>
+std::expected<std::array<deye::sensor_value, SensorIds.size()>, std::error_code> deye::connector<Socket>::read_sensors()
+{
+	using plan = detail::read_planner::static_plan<SensorIds, Config>;
+
+	static_assert(plan::request_frame_size <= buffer_size, "Read request exceeds local buffer size.");
+	static_assert(plan::max_response_frame_size <= buffer_size, "Read response exceeds local buffer size.");
+
+	if (m_sensors.data() != config::sensors.data())
+	{
+		return std::unexpected{ connector_error::make_error_code(connector_error::codes::sensor_table_mismatch) };
+	}
+
+	auto values = std::array<sensor_value, SensorIds.size()>{};
+
+	const auto decode_range = [&]<std::size_t RangeIndex>(
+		std::integral_constant<std::size_t, RangeIndex>,
+		const std::uint16_t* registers
+	) {
+		[&]<std::size_t... SlotIndices>(std::index_sequence<SlotIndices...>)
 		{
-			if (returned_address.value() != begin_address)
+			([&]
 			{
-				return make_error_code(codes::response_wrong_address);
-			}
-		}
-		else
-		{
-			return returned_address.error();
-		}
+				static constexpr auto slot = plan::slots[SlotIndices];
+				if constexpr (slot.range_index == RangeIndex)
+				{
+					values[SlotIndices] = detail::decode_sensor<slot.sensor_index>(registers + slot.offset);
+				}
+			}(), ...);
+		}(std::make_index_sequence<SensorIds.size()>{});
+	};
 
-		if (const auto returned_count = bytes::to<std::uint16_t, std::endian::big>(res, 4))
+	const auto error = read_register_ranges(
+		plan::ranges,
+		Config.max_frames_in_flight,
+		[&](const std::size_t range_index, std::span<const std::uint16_t> registers) -> std::error_code
 		{
-			if (returned_count.value() != values.size())
+			// Responses may arrive in any order, dispatch to the decoder generated for the range.
+			[&]<std::size_t... RangeIndices>(std::index_sequence<RangeIndices...>)
 			{
-				return make_error_code(codes::response_wrong_address);
-			}
-		}
-		else
-		{
-			return returned_count.error();
+				((range_index == RangeIndices and (
+					decode_range(std::integral_constant<std::size_t, RangeIndices>{}, registers.data()), true
+				)) or ...);
+			}(std::make_index_sequence<plan::ranges.size()>{});
+
+			return {};
 		}
+	);
 
-		return {};
-	};
+	if (error)
+	{
+		return std::unexpected{ error };
+	}
 
-	return modbus_request(request_size, write_request, read_request);
+	return values;
 }
 
 template<deye::detail::tcp_socket Socket>
-[[nodiscard]] std::expected<deye::sensor_value, std::error_code> deye::connector<Socket>::read_sensor(
-	const config::sensor_id id
+std::error_code deye::connector<Socket>::read_register_image(
+	std::span<const register_range> ranges,
+	const std::uint16_t image_begin_address,
+	std::span<std::uint16_t> image
 ) {
-	using connector_error::make_error_code;
-
-	if (const auto sensor_meta = sensor_meta_by_id(id))
+	for (const auto& range : ranges)
 	{
-		if (const auto registers = read_registers(
-			sensor_meta->begin_address, sensor_meta->register_count
-		)) {
-			if (const auto value = sensor_meta->rep.interpret(registers.value()))
-			{
-				return value.value();
-			}
-			else
-			{
-				return std::unexpected{ value.error() };
-			}
-		}
-		else
-		{
-			return std::unexpected{ registers.error() };
+		if (
+			range.begin_address < image_begin_address or
+			static_cast<std::size_t>(range.begin_address - image_begin_address) + range.register_count > image.size()
+		) {
+			return connector_error::make_error_code(connector_error::codes::action_exceeds_local_buffer_size);
 		}
 	}
-	else
+
+	if (ranges.empty())
 	{
-		return std::unexpected{ make_error_code(connector_error::codes::unknown_sensor) };
+		return {};
 	}
+
+	return read_register_ranges(
+		ranges,
+		m_read_plan.max_frames_in_flight,
+		[&](const std::size_t range_index, std::span<const std::uint16_t> registers) -> std::error_code
+		{
+			std::ranges::copy(registers, image.begin() + (ranges[range_index].begin_address - image_begin_address));
+			return {};
+		}
+	);
 }
 
 template<deye::detail::tcp_socket Socket>
-std::error_code deye::connector<Socket>::read_sensors(
+std::error_code deye::connector<Socket>::write_sensor(const config::sensor_id id, const sensor_value& value)
+{
+	return write_sensors(std::span{ &id, 1 }, std::span{ &value, 1 });
+}
+
+template<deye::detail::tcp_socket Socket>
+std::error_code deye::connector<Socket>::write_sensors(
 	std::span<const config::sensor_id> sensor_ids,
-	std::span<sensor_value> sensor_values
+	std::span<const sensor_value> values
 ) {
 	using connector_error::make_error_code;
+	using connector_error::codes;
 
-	if (sensor_ids.size() != sensor_values.size())
+	if (sensor_ids.size() != values.size())
 	{
-		return make_error_code(connector_error::codes::num_sensors_values_mismatch);
+		return make_error_code(codes::num_sensors_values_mismatch);
 	}
 
-	if (sensor_ids.empty())
+	// Every value is encoded once up front to validate it. The value of every written sensor is looked up
+	// through a table indexed like the sensor table, so the writes come out sorted by address.
+	auto is_written = std::bitset<max_sensor_table_size>{};
+	auto value_indices = std::array<std::uint32_t, max_sensor_table_size>{};
+	auto scratch = std::array<std::uint16_t, sensor_value::registers::max_size>{};
+
+	for (std::size_t i{}; i != sensor_ids.size(); ++i)
 	{
-		return {};
-	}
+		const auto index = static_cast<std::size_t>(sensor_ids[i]);
+		if (index >= m_sensors.size())
+		{
+			return make_error_code(codes::unknown_sensor);
+		}
 
-	using address_limits = std::numeric_limits<std::uint16_t>;
-	std::uint16_t begin_address{ address_limits::max() }, end_address{ address_limits::min() };
+		const auto& sensor = m_sensors[index];
 
-	for (const auto& sensor_id : sensor_ids)
+		if (sensor.register_count > sensor_value::registers::max_size)
+		{
+			return std::make_error_code(std::errc::result_out_of_range);
+		}
+
+		if (const auto error = sensor.rep.encode(values[i], std::span{ scratch }.first(sensor.register_count)))
+		{
+			return error;
+		}
+
+		if (is_written[index])
+		{
+			return make_error_code(codes::duplicate_sensor_writes);
+		}
+
+		is_written[index] = true;
+		value_indices[index] = static_cast<std::uint32_t>(i);
+	}
+
+	// The table is sorted by address, so written sensors overlap iff one begins before an earlier one ends.
+	auto written_end = std::size_t{};
+	for (std::size_t index{}; index != m_sensors.size(); ++index)
 	{
-		if (const auto sensor = sensor_meta_by_id(sensor_id))
+		if (not is_written[index])
 		{
-			begin_address = std::min(begin_address, sensor->begin_address);
-			end_address = std::max(end_address, static_cast<std::uint16_t>(sensor->begin_address + sensor->register_count));
+			continue;
 		}
-		else
+
+		const auto& sensor = m_sensors[index];
+		if (sensor.begin_address < written_end)
 		{
-			return make_error_code(connector_error::codes::unknown_sensor);
+			return make_error_code(codes::overlapping_sensor_writes);
 		}
+		written_end = std::max(written_end, std::size_t{ sensor.begin_address } + sensor.register_count);
 	}
 
-	const auto register_count = end_address - begin_address;
+	// Sensors that continue the registers of the previous one are appended to the same request.
+	auto run = std::array<std::uint16_t, detail::modbus::max_write_register_count>{};
+	auto run_begin = std::size_t{};
+	auto run_size = std::size_t{};
 
-	if (const auto registers = read_registers(begin_address, register_count))
+	const auto flush = [&]() -> std::error_code
 	{
-		for (auto [ sensor_id, sensor_value ] : std::views::zip(sensor_ids, sensor_values))
+		if (run_size == 0)
 		{
-			const auto sensor_meta = *sensor_meta_by_id(sensor_id);
-			if (const auto value = sensor_meta.rep.interpret(
-				registers->subspan(
-					sensor_meta.begin_address - begin_address,
-					sensor_meta.register_count
-				)
-			)) {
-				sensor_value = value.value();
-			}
-			else
+			return {};
+		}
+		const auto error = write_registers(static_cast<std::uint16_t>(run_begin), std::span{ run }.first(run_size));
+		run_size = 0;
+		return error;
+	};
+
+	for (std::size_t index{}; index != m_sensors.size(); ++index)
+	{
+		if (not is_written[index])
+		{
+			continue;
+		}
+
+		const auto& sensor = m_sensors[index];
+		const auto run_end = run_begin + run_size;
+
+		if (run_size != 0 and (
+			sensor.begin_address != run_end or
+			run_size + sensor.register_count > run.size()
+		)) {
+			if (const auto error = flush())
 			{
-				return value.error();
+				return error;
 			}
 		}
-	}
-	else
-	{
-		return registers.error();
+
+		if (run_size == 0)
+		{
+			run_begin = sensor.begin_address;
+		}
+
+		// Already validated above, so encoding into the run can't fail.
+		[[maybe_unused]] const auto error = sensor.rep.encode(
+			values[value_indices[index]],
+			std::span{ run }.subspan(run_size, sensor.register_count)
+		);
+		run_size += sensor.register_count;
 	}
 
-	return {};
+	return flush();
 }
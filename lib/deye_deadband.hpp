@@ -0,0 +1,266 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <bit>
+#include <cmath>
+#include <vector>
+
+namespace deye
+{
+
+/**
+ * @brief The band around the last reported value within which changes of a numeric sensor are not reported.
+ *
+ * A value is reported once it differs from the last reported one by more than
+ * `max(absolute, relative * |last reported value|)`. The default reports every change.
+ */
+struct deadband
+{
+	double absolute{ 0.0 };
+	double relative{ 0.0 };
+};
+
+struct change_filter_stats
+{
+	std::uint64_t values{}, reported{}, full_refreshes{};
+};
+
+/**
+ * @brief Reduces the values of successive `read_sensors` calls to the ones that changed.
+ *
+ * Integer and physical sensors are compared against their deadband,
+ * enumeration and register sensors are compared exactly.
+ * Every `full_refresh_interval` all values of a call are reported regardless,
+ * so consumers that missed a change or joined late catch up.
+ * Empty values are never reported.
+ */
+class change_filter
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	explicit change_filter(clock::duration full_refresh_interval = std::chrono::minutes{ 5 });
+
+	/**
+	 * @brief Reads the given sensors and calls `on_change(sensor_id, value)` for every value that is reported.
+	 *
+	 * @return `connector_error::codes::sensor_table_mismatch` if the connector uses another table than `config::sensors`.
+	 */
+	template<detail::tcp_socket Socket, class F>
+	[[nodiscard]] std::error_code poll(
+		connector<Socket>& connector,
+		std::span<const config::sensor_id> sensor_ids,
+		F&& on_change
+	);
+
+	/**
+	 * @brief Calls `on_change(sensor_id, value)` for every value of one `read_sensors` call that is reported.
+	 */
+	template<class F>
+	[[nodiscard]] std::error_code filter(
+		clock::time_point now,
+		std::span<const config::sensor_id> sensor_ids,
+		std::span<const sensor_value> values,
+		F&& on_change
+	);
+
+	[[nodiscard]] std::error_code set_deadband(config::sensor_id id, deadband band);
+
+	// Reports all values of the next call.
+	void request_full_refresh();
+
+	[[nodiscard]] const change_filter_stats& stats() const;
+
+private:
+	struct sensor_state
+	{
+		sensor_value last{};
+		deadband band{};
+	};
+
+	[[nodiscard]] static bool changed(const sensor_state& state, const sensor_value& value);
+
+	[[nodiscard]] static bool outside_band(const deadband& band, double value, double last);
+
+	[[nodiscard]] static std::optional<double> numeric_value(const sensor_value& value);
+
+	clock::duration m_full_refresh_interval;
+	std::optional<clock::time_point> m_next_full_refresh{};
+	std::array<sensor_state, config::sensors.size()> m_sensors{};
+	std::vector<sensor_value> m_values{};
+	change_filter_stats m_stats{};
+};
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+inline deye::change_filter::change_filter(const clock::duration full_refresh_interval) :
+	m_full_refresh_interval{ full_refresh_interval }
+{}
+
+template<deye::detail::tcp_socket Socket, class F>
+std::error_code deye::change_filter::poll(
+	connector<Socket>& connector,
+	std::span<const config::sensor_id> sensor_ids,
+	F&& on_change
+) {
+	// Deadbands and last reported values belong to the ids of `config::sensors`.
+	if (connector.sensors().data() != config::sensors.data())
+	{
+		return connector_error::make_error_code(connector_error::codes::sensor_table_mismatch);
+	}
+
+	m_values.resize(sensor_ids.size());
+
+	if (const auto error = connector.read_sensors(sensor_ids, m_values))
+	{
+		return error;
+	}
+
+	return filter(clock::now(), sensor_ids, m_values, std::forward<F>(on_change));
+}
+
+template<class F>
+std::error_code deye::change_filter::filter(
+	const clock::time_point now,
+	std::span<const config::sensor_id> sensor_ids,
+	std::span<const sensor_value> values,
+	F&& on_change
+) {
+	using connector_error::make_error_code;
+
+	if (sensor_ids.size() != values.size())
+	{
+		return make_error_code(connector_error::codes::num_sensors_values_mismatch);
+	}
+
+	// Checked up front, so a bad id doesn't leave some sensors reported and others not.
+	for (const auto id : sensor_ids)
+	{
+		if (static_cast<std::size_t>(id) >= m_sensors.size())
+		{
+			return make_error_code(connector_error::codes::unknown_sensor);
+		}
+	}
+
+	const auto full_refresh = not m_next_full_refresh or now >= *m_next_full_refresh;
+	if (full_refresh)
+	{
+		m_next_full_refresh = now + m_full_refresh_interval;
+		++m_stats.full_refreshes;
+	}
+
+	for (std::size_t i{}; i != sensor_ids.size(); ++i)
+	{
+		const auto id = sensor_ids[i];
+		const auto& value = values[i];
+
+		++m_stats.values;
+
+		auto& state = m_sensors[static_cast<std::size_t>(id)];
+
+		if (value.type() == sensor_value_rep_id::empty)
+		{
+			continue;
+		}
+
+		if (full_refresh or changed(state, value))
+		{
+			state.last = value;
+			++m_stats.reported;
+			on_change(id, std::as_const(value));
+		}
+	}
+
+	return {};
+}
+
+inline std::error_code deye::change_filter::set_deadband(const config::sensor_id id, const deadband band)
+{
+	const auto index = static_cast<std::size_t>(id);
+	if (index >= m_sensors.size())
+	{
+		return connector_error::make_error_code(connector_error::codes::unknown_sensor);
+	}
+
+	m_sensors[index].band = band;
+
+	return {};
+}
+
+inline void deye::change_filter::request_full_refresh()
+{
+	m_next_full_refresh = std::nullopt;
+}
+
+inline const deye::change_filter_stats& deye::change_filter::stats() const
+{
+	return m_stats;
+}
+
+inline bool deye::change_filter::changed(const sensor_state& state, const sensor_value& value)
+{
+	if (value.type() != state.last.type())
+	{
+		return true;
+	}
+
+	switch (value.type())
+	{
+	case sensor_value_rep_id::registers:
+		return value.get<sensor_value::registers>()->data != state.last.get<sensor_value::registers>()->data;
+	case sensor_value_rep_id::enumeration:
+	{
+		const auto current = *value.get<sensor_value::enumeration>();
+		const auto last = *state.last.get<sensor_value::enumeration>();
+		return current.index != last.index or current.enum_id != last.enum_id;
+	}
+	case sensor_value_rep_id::integer:
+		if (state.band.absolute == 0.0 and state.band.relative == 0.0)
+		{
+			return value.get<sensor_value::integer>()->value != state.last.get<sensor_value::integer>()->value;
+		}
+		return outside_band(state.band, *numeric_value(value), *numeric_value(state.last));
+	case sensor_value_rep_id::physical:
+	{
+		const auto current = *value.get<sensor_value::physical>();
+		const auto last = *state.last.get<sensor_value::physical>();
+		return current.unit_id != last.unit_id or outside_band(state.band, current.value, last.value);
+	}
+	default:
+		return false;
+	}
+}
+
+inline bool deye::change_filter::outside_band(const deadband& band, const double value, const double last)
+{
+	const auto width = std::max(band.absolute, band.relative * std::abs(last));
+	// Without a band every change counts, including the ones of NaN values.
+	if (width == 0.0)
+	{
+		return std::bit_cast<std::uint64_t>(value) != std::bit_cast<std::uint64_t>(last);
+	}
+	return std::abs(value - last) > width;
+}
+
+inline std::optional<double> deye::change_filter::numeric_value(const sensor_value& value)
+{
+	if (const auto integer = value.get<sensor_value::integer>())
+	{
+		return static_cast<double>(integer->value);
+	}
+	if (const auto physical = value.get<sensor_value::physical>())
+	{
+		return physical->value;
+	}
+	return std::nullopt;
+}
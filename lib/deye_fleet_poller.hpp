@@ -0,0 +1,368 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace deye
+{
+
+struct fleet_device
+{
+	std::string host;
+	std::uint16_t port;
+	serial_number_type serial_number;
+	std::vector<config::sensor_id> sensor_ids;
+};
+
+struct fleet_device_stats
+{
+	std::uint64_t polls{}, errors{};
+	std::chrono::nanoseconds last_cycle{}, max_cycle{}, total_cycle{};
+	std::error_code last_error{};
+};
+
+struct fleet_stats
+{
+	double polls_per_second{};
+	std::uint64_t polls{}, errors{}, steals{};
+	std::vector<fleet_device_stats> devices;
+};
+
+/**
+ * @brief Polls many loggers on a fixed pool of worker threads.
+ *
+ * Every device is a job that lives in the queue of exactly one worker, ordered by due time.
+ * Workers poll the due jobs of their own queue first and steal due jobs from the other queues
+ * when they run dry, so a few slow loggers only ever block the worker that is currently polling them.
+ * A stolen job stays with the thief, which over time moves devices away from overloaded workers.
+ */
+template<detail::tcp_socket Socket>
+class fleet_poller
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	/**
+	 * @brief Called from the worker threads after every poll cycle of a device.
+	 *
+	 * @param device_index The index of the device in the list given to the constructor.
+	 * @param values The values in the order of the devices `sensor_ids`, only valid if `error` is not set.
+	 */
+	using callback_type = std::function<void(
+		std::size_t device_index,
+		std::span<const sensor_value> values,
+		std::error_code error
+	)>;
+
+	fleet_poller(
+		std::vector<fleet_device> devices,
+		std::size_t worker_count,
+		clock::duration poll_interval,
+		callback_type on_poll
+	);
+
+	fleet_poller(const fleet_poller&) = delete;
+	fleet_poller& operator=(const fleet_poller&) = delete;
+
+	void start();
+
+	void stop();
+
+	[[nodiscard]] fleet_stats stats() const;
+
+	~fleet_poller();
+
+private:
+	struct device_state
+	{
+		fleet_device info;
+		deye::connector<Socket> connection;
+		std::vector<sensor_value> values;
+		bool connected{ false };
+		clock::time_point due{};
+
+		mutable std::mutex stats_mutex{};
+		fleet_device_stats stats{};
+	};
+
+	struct worker
+	{
+		mutable std::mutex mutex{};
+		std::deque<std::size_t> jobs{};
+		std::thread thread{};
+	};
+
+	void run(std::size_t worker_index);
+
+	[[nodiscard]] std::optional<std::size_t> pop_due(worker& w, clock::time_point now);
+
+	void push(worker& w, std::size_t device_index);
+
+	void poll(device_state& device, std::size_t device_index);
+
+	std::vector<std::unique_ptr<device_state>> m_devices;
+	std::vector<std::unique_ptr<worker>> m_workers;
+	clock::duration m_poll_interval;
+	callback_type m_on_poll;
+
+	std::atomic<bool> m_running{ false };
+	std::atomic<std::uint64_t> m_steals{ 0 };
+	clock::time_point m_start_time{};
+};
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+template<deye::detail::tcp_socket Socket>
+deye::fleet_poller<Socket>::fleet_poller(
+	std::vector<fleet_device> devices,
+	const std::size_t worker_count,
+	const clock::duration poll_interval,
+	callback_type on_poll
+) :
+	m_poll_interval{ poll_interval },
+	m_on_poll{ std::move(on_poll) }
+{
+	m_devices.reserve(devices.size());
+	for (auto& device : devices)
+	{
+		const auto serial_number = device.serial_number;
+		auto state = std::make_unique<device_state>(std::move(device), serial_number);
+		state->values.resize(state->info.sensor_ids.size());
+		m_devices.push_back(std::move(state));
+	}
+
+	m_workers.resize(std::max(worker_count, std::size_t{ 1 }));
+	for (auto& w : m_workers)
+	{
+		w = std::make_unique<worker>();
+	}
+
+	// Shard the devices round robin, their due times are set by `start`.
+	for (std::size_t i{}; i != m_devices.size(); ++i)
+	{
+		m_workers[i % m_workers.size()]->jobs.push_back(i);
+	}
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::fleet_poller<Socket>::start()
+{
+	if (m_running.exchange(true))
+	{
+		return;
+	}
+
+	m_start_time = clock::now();
+
+	// Spread the first poll of every device over the interval so the workers don't all hit the network at the same instant.
+	// The due times are set anew instead of offset, so starting again after `stop` doesn't push them further out.
+	const auto device_count = std::max(m_devices.size(), std::size_t{ 1 });
+	for (std::size_t i{}; i != m_devices.size(); ++i)
+	{
+		m_devices[i]->due = m_start_time + (m_poll_interval * i) / device_count;
+	}
+
+	// Steals before a `stop` may have mixed up the queues, the due times grow with the device index.
+	for (auto& w : m_workers)
+	{
+		std::ranges::sort(w->jobs);
+	}
+
+	for (std::size_t i{}; i != m_workers.size(); ++i)
+	{
+		m_workers[i]->thread = std::thread(&fleet_poller::run, this, i);
+	}
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::fleet_poller<Socket>::stop()
+{
+	m_running = false;
+
+	for (auto& w : m_workers)
+	{
+		if (w->thread.joinable())
+		{
+			w->thread.join();
+		}
+	}
+}
+
+template<deye::detail::tcp_socket Socket>
+deye::fleet_poller<Socket>::~fleet_poller()
+{
+	stop();
+}
+
+template<deye::detail::tcp_socket Socket>
+deye::fleet_stats deye::fleet_poller<Socket>::stats() const
+{
+	auto result = fleet_stats{};
+	result.devices.reserve(m_devices.size());
+
+	for (const auto& device : m_devices)
+	{
+		const auto lock = std::scoped_lock{ device->stats_mutex };
+		result.devices.push_back(device->stats);
+		result.polls += device->stats.polls;
+		result.errors += device->stats.errors;
+	}
+
+	result.steals = m_steals;
+
+	if (m_start_time != clock::time_point{})
+	{
+		const auto elapsed = std::chrono::duration<double>(clock::now() - m_start_time).count();
+		if (elapsed > 0.0)
+		{
+			result.polls_per_second = static_cast<double>(result.polls) / elapsed;
+		}
+	}
+
+	return result;
+}
+
+template<deye::detail::tcp_socket Socket>
+std::optional<std::size_t> deye::fleet_poller<Socket>::pop_due(worker& w, const clock::time_point now)
+{
+	const auto lock = std::scoped_lock{ w.mutex };
+
+	if (w.jobs.empty() or m_devices[w.jobs.front()]->due > now)
+	{
+		return std::nullopt;
+	}
+
+	const auto device_index = w.jobs.front();
+	w.jobs.pop_front();
+
+	return device_index;
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::fleet_poller<Socket>::push(worker& w, const std::size_t device_index)
+{
+	const auto lock = std::scoped_lock{ w.mutex };
+
+	// Keep the queue ordered by due time, usually this is just an append.
+	const auto due = m_devices[device_index]->due;
+	const auto it = std::find_if(w.jobs.rbegin(), w.jobs.rend(), [&](const std::size_t other) {
+		return m_devices[other]->due <= due;
+	});
+
+	w.jobs.insert(it.base(), device_index);
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::fleet_poller<Socket>::run(const std::size_t worker_index)
+{
+	using namespace std::chrono_literals;
+
+	auto& self = *m_workers[worker_index];
+
+	// Upper bound for how long an idle worker sleeps before looking for work to steal.
+	const auto max_idle = std::clamp<clock::duration>(m_poll_interval / 20, 1ms, 50ms);
+
+	while (m_running)
+	{
+		const auto now = clock::now();
+
+		auto job = pop_due(self, now);
+
+		for (std::size_t i = 1; not job and i != m_workers.size(); ++i)
+		{
+			if ((job = pop_due(*m_workers[(worker_index + i) % m_workers.size()], now)))
+			{
+				++m_steals;
+			}
+		}
+
+		if (job)
+		{
+			auto& device = *m_devices[*job];
+			poll(device, *job);
+
+			// Skip cycles that were missed completely instead of polling them back to back.
+			device.due += m_poll_interval;
+			if (const auto after_poll = clock::now(); device.due < after_poll)
+			{
+				device.due = after_poll;
+			}
+
+			push(self, *job);
+			continue;
+		}
+
+		auto wake_up = now + max_idle;
+		{
+			const auto lock = std::scoped_lock{ self.mutex };
+			if (not self.jobs.empty())
+			{
+				wake_up = std::min(wake_up, m_devices[self.jobs.front()]->due);
+			}
+		}
+
+		std::this_thread::sleep_until(wake_up);
+	}
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::fleet_poller<Socket>::poll(device_state& device, const std::size_t device_index)
+{
+	const auto begin = clock::now();
+
+	auto error = std::error_code{};
+
+	if (not device.connected)
+	{
+		error = device.connection.connect(device.info.host.c_str(), device.info.port);
+		device.connected = not error;
+	}
+
+	if (not error)
+	{
+		error = device.connection.read_sensors(device.info.sensor_ids, device.values);
+	}
+
+	if (error and device.connected)
+	{
+		// Start the next cycle with a fresh connection, the stream may be out of sync.
+		[[maybe_unused]] const auto disconnect_error = device.connection.disconnect();
+		device.connected = false;
+	}
+
+	const auto cycle = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - begin);
+
+	{
+		const auto lock = std::scoped_lock{ device.stats_mutex };
+		auto& stats = device.stats;
+		++stats.polls;
+		stats.errors += static_cast<bool>(error);
+		stats.last_cycle = cycle;
+		stats.max_cycle = std::max(stats.max_cycle, cycle);
+		stats.total_cycle += cycle;
+		stats.last_error = error;
+	}
+
+	if (m_on_poll)
+	{
+		m_on_poll(device_index, device.values, error);
+	}
+}
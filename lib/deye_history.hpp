@@ -0,0 +1,798 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <bit>
+#include <vector>
+
+namespace deye
+{
+
+struct history_config
+{
+	// The number of samples compressed into one block.
+	// Queries skip whole blocks outside of their time range and decode the others sample by sample.
+	std::uint32_t block_size{ 4096 };
+
+	// The number of blocks kept per sensor, the oldest block is reused once all are full.
+	// The defaults keep a little more than three weeks of 1 s samples.
+	std::uint32_t block_count{ 512 };
+};
+
+/**
+ * @brief Aggregate of the samples within one interval of `history::downsample`.
+ *
+ * Enumerations are aggregated by their index.
+ */
+struct history_bucket
+{
+	std::chrono::system_clock::time_point begin;
+	std::size_t count;
+	double min, max, mean;
+	sensor_value last;
+};
+
+namespace detail::gorilla
+{
+
+/**
+ * @brief Append only bit stream, bits are stored least significant bit first.
+ */
+struct bit_writer
+{
+	std::vector<std::uint64_t>& words;
+	std::uint64_t& bit_count;
+
+	inline void write(std::uint64_t value, unsigned bits);
+};
+
+struct bit_reader
+{
+	std::span<const std::uint64_t> words;
+	std::uint64_t position{};
+
+	[[nodiscard]] inline std::uint64_t read(unsigned bits);
+};
+
+/**
+ * @brief A fixed number of samples compressed with delta-of-delta timestamps and XOR encoded values.
+ *
+ * Timestamps are milliseconds, values are the 64 bit patterns of the samples.
+ * The first sample is stored uncompressed.
+ */
+struct block
+{
+	std::vector<std::uint64_t> words{};
+	std::uint64_t bit_count{};
+	std::uint32_t sample_count{};
+	std::int64_t begin_time{}, end_time{};
+
+	// Encoder state
+	std::int64_t last_delta{};
+	std::uint64_t last_value{};
+	std::uint8_t leading{}, trailing{};
+
+	inline void append(std::int64_t time, std::uint64_t value);
+
+	inline void reset();
+};
+
+class block_decoder
+{
+public:
+	inline explicit block_decoder(const block& source);
+
+	/**
+	 * @return false if all samples of the block have been decoded.
+	 */
+	[[nodiscard]] inline bool next();
+
+	[[nodiscard]] inline std::int64_t time() const;
+
+	[[nodiscard]] inline std::uint64_t value() const;
+
+private:
+	bit_reader m_reader;
+	std::uint32_t m_remaining, m_decoded{};
+	std::int64_t m_time{}, m_delta{};
+	std::uint64_t m_value{};
+	std::uint8_t m_leading{}, m_trailing{};
+};
+
+} // namespace detail::gorilla
+
+/**
+ * @brief Keeps a compressed, fixed capacity history of the values of every sensor.
+ *
+ * Values are stored Gorilla style: timestamps as delta-of-delta and values as the XOR with their predecessor,
+ * so slowly changing counters and power values take only a few bits per sample.
+ * Samples of register sensors and empty values are not recorded.
+ *
+ * @note Samples of one sensor have to be recorded in chronological order.
+ */
+class history
+{
+public:
+	using clock = std::chrono::system_clock;
+
+	explicit history(history_config config = {});
+
+	/**
+	 * @brief Reads the given sensors and records their values with the current time.
+	 *
+	 * @return `connector_error::codes::sensor_table_mismatch` if the connector uses another table than `config::sensors`.
+	 */
+	template<detail::tcp_socket Socket>
+	[[nodiscard]] std::error_code poll(connector<Socket>& connector, std::span<const config::sensor_id> sensor_ids);
+
+	/**
+	 * @brief Records the values of one `read_sensors` call.
+	 *
+	 * @return `connector_error::codes::unknown_sensor` for unknown sensor ids and
+	 * `std::errc::invalid_argument` if a sample is older than the last sample of its sensor,
+	 * all other samples are still recorded.
+	 */
+	[[nodiscard]] std::error_code record(
+		clock::time_point time,
+		std::span<const config::sensor_id> sensor_ids,
+		std::span<const sensor_value> values
+	);
+
+	[[nodiscard]] std::error_code record(clock::time_point time, config::sensor_id id, const sensor_value& value);
+
+	/**
+	 * @brief Calls `on_sample(time, value)` for every sample of the sensor in `[begin, end)` in chronological order.
+	 */
+	template<class F>
+	void query(config::sensor_id id, clock::time_point begin, clock::time_point end, F&& on_sample) const;
+
+	/**
+	 * @brief Calls `on_bucket(bucket)` for every non empty interval of length `interval` in `[begin, end)`.
+	 *
+	 * Intervals start at `begin`, only the blocks that overlap the range are decoded.
+	 */
+	template<class F>
+	void downsample(
+		config::sensor_id id,
+		clock::time_point begin,
+		clock::time_point end,
+		clock::duration interval,
+		F&& on_bucket
+	) const;
+
+	[[nodiscard]] std::size_t sample_count(config::sensor_id id) const;
+
+	// The number of bytes used by the compressed samples of all sensors.
+	[[nodiscard]] std::size_t compressed_size() const;
+
+	void clear();
+
+private:
+	struct series
+	{
+		std::vector<detail::gorilla::block> blocks{};
+		std::size_t first{}, count{};
+	};
+
+	template<class F>
+	void for_each_sample(config::sensor_id id, std::int64_t begin, std::int64_t end, F&& on_sample) const;
+
+	[[nodiscard]] static std::int64_t to_milliseconds(clock::time_point time);
+
+	[[nodiscard]] static clock::time_point from_milliseconds(std::int64_t time);
+
+	[[nodiscard]] static std::optional<std::uint64_t> encode_value(const sensor_meta& meta, const sensor_value& value);
+
+	[[nodiscard]] static sensor_value decode_value(const sensor_meta& meta, std::uint64_t value);
+
+	[[nodiscard]] static double numeric_value(const sensor_meta& meta, std::uint64_t value);
+
+	history_config m_config;
+	std::array<series, config::sensors.size()> m_series{};
+	std::vector<sensor_value> m_values{};
+};
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+//--------------[ gorilla encoding ]--------------//
+
+inline void deye::detail::gorilla::bit_writer::write(std::uint64_t value, const unsigned bits)
+{
+	if (bits == 0)
+	{
+		return;
+	}
+
+	if (bits < 64)
+	{
+		value &= (std::uint64_t{ 1 } << bits) - 1;
+	}
+
+	const auto offset = static_cast<unsigned>(bit_count % 64);
+	if (offset == 0)
+	{
+		words.push_back(0);
+	}
+
+	words.back() |= value << offset;
+	if (offset + bits > 64)
+	{
+		words.push_back(value >> (64 - offset));
+	}
+
+	bit_count += bits;
+}
+
+inline std::uint64_t deye::detail::gorilla::bit_reader::read(const unsigned bits)
+{
+	if (bits == 0)
+	{
+		return 0;
+	}
+
+	const auto index = position / 64;
+	const auto offset = static_cast<unsigned>(position % 64);
+
+	auto value = words[index] >> offset;
+	if (offset + bits > 64)
+	{
+		value |= words[index + 1] << (64 - offset);
+	}
+
+	if (bits < 64)
+	{
+		value &= (std::uint64_t{ 1 } << bits) - 1;
+	}
+
+	position += bits;
+
+	return value;
+}
+
+namespace deye::detail::gorilla
+{
+
+// Control bits and payload sizes of the delta-of-delta timestamp encoding,
+// the prefixes are written least significant bit first: 10, 110, 1110 and 1111.
+struct timestamp_class
+{
+	std::uint64_t prefix;
+	unsigned prefix_bits, value_bits;
+};
+
+inline constexpr auto timestamp_classes = std::array<timestamp_class, 4>{{
+	{ 0b01, 2, 7 },
+	{ 0b011, 3, 9 },
+	{ 0b0111, 4, 12 },
+	{ 0b1111, 4, 32 }
+}};
+
+inline constexpr unsigned large_timestamp_bits = 64;
+
+[[nodiscard]] constexpr bool fits_signed(const std::int64_t value, const unsigned bits)
+{
+	const auto limit = std::int64_t{ 1 } << (bits - 1);
+	return -limit <= value and value < limit;
+}
+
+[[nodiscard]] constexpr std::int64_t sign_extend(const std::uint64_t value, const unsigned bits)
+{
+	const auto shift = 64 - bits;
+	return static_cast<std::int64_t>(value << shift) >> shift;
+}
+
+} // namespace deye::detail::gorilla
+
+inline void deye::detail::gorilla::block::append(const std::int64_t time, const std::uint64_t value)
+{
+	auto writer = bit_writer{ words, bit_count };
+
+	if (sample_count == 0)
+	{
+		writer.write(static_cast<std::uint64_t>(time), 64);
+		writer.write(value, 64);
+		begin_time = end_time = time;
+		last_value = value;
+		last_delta = 0;
+		leading = trailing = 0;
+		sample_count = 1;
+		return;
+	}
+
+	//--------------[ timestamp ]--------------//
+
+	const auto delta = time - end_time;
+	const auto delta_of_delta = delta - last_delta;
+
+	if (delta_of_delta == 0)
+	{
+		writer.write(0b0, 1);
+	}
+	else
+	{
+		const auto it = std::ranges::find_if(
+			timestamp_classes,
+			[&](const timestamp_class& c) { return fits_signed(delta_of_delta, c.value_bits); }
+		);
+		const auto& c = it == timestamp_classes.end() ? timestamp_classes.back() : *it;
+
+		writer.write(c.prefix, c.prefix_bits);
+
+		auto value_bits = c.value_bits;
+		if (&c == &timestamp_classes.back())
+		{
+			// The last class is followed by a flag that selects the 32 or 64 bit form.
+			const auto large = not fits_signed(delta_of_delta, c.value_bits);
+			writer.write(large, 1);
+			value_bits = large ? large_timestamp_bits : c.value_bits;
+		}
+
+		writer.write(static_cast<std::uint64_t>(delta_of_delta), value_bits);
+	}
+
+	//--------------[ value ]--------------//
+
+	const auto xor_value = value ^ last_value;
+
+	if (xor_value == 0)
+	{
+		writer.write(0b0, 1);
+	}
+	else
+	{
+		const auto new_leading = static_cast<std::uint8_t>(std::min(std::countl_zero(xor_value), 31));
+		const auto new_trailing = static_cast<std::uint8_t>(std::countr_zero(xor_value));
+
+		// An all zero window marks the start of the block, where there is no window to reuse yet.
+		if ((leading != 0 or trailing != 0) and new_leading >= leading and new_trailing >= trailing)
+		{
+			// Reuse the window of meaningful bits of the previous value.
+			writer.write(0b01, 2);
+			writer.write(xor_value >> trailing, 64 - leading - trailing);
+		}
+		else
+		{
+			const auto meaningful = 64u - new_leading - new_trailing;
+			writer.write(0b11, 2);
+			writer.write(new_leading, 5);
+			writer.write(meaningful - 1, 6);
+			writer.write(xor_value >> new_trailing, meaningful);
+			leading = new_leading;
+			trailing = new_trailing;
+		}
+	}
+
+	end_time = time;
+	last_delta = delta;
+	last_value = value;
+	++sample_count;
+}
+
+inline void deye::detail::gorilla::block::reset()
+{
+	// Keeps the capacity, so a ring of reused blocks stops allocating once it is full.
+	words.clear();
+	bit_count = 0;
+	sample_count = 0;
+	begin_time = end_time = 0;
+	last_delta = 0;
+	last_value = 0;
+	leading = trailing = 0;
+}
+
+inline deye::detail::gorilla::block_decoder::block_decoder(const block& source) :
+	m_reader{ source.words },
+	m_remaining{ source.sample_count }
+{}
+
+inline bool deye::detail::gorilla::block_decoder::next()
+{
+	if (m_remaining == 0)
+	{
+		return false;
+	}
+	--m_remaining;
+
+	if (m_decoded++ == 0)
+	{
+		m_time = static_cast<std::int64_t>(m_reader.read(64));
+		m_value = m_reader.read(64);
+		return true;
+	}
+
+	if (m_reader.read(1) != 0)
+	{
+		// The number of further one bits selects the class.
+		auto class_index = std::size_t{};
+		while (class_index + 1 != timestamp_classes.size() and m_reader.read(1) != 0)
+		{
+			++class_index;
+		}
+
+		auto value_bits = timestamp_classes[class_index].value_bits;
+		if (class_index + 1 == timestamp_classes.size() and m_reader.read(1) != 0)
+		{
+			value_bits = large_timestamp_bits;
+		}
+
+		m_delta += sign_extend(m_reader.read(value_bits), value_bits);
+	}
+	m_time += m_delta;
+
+	if (m_reader.read(1) != 0)
+	{
+		if (m_reader.read(1) != 0)
+		{
+			m_leading = static_cast<std::uint8_t>(m_reader.read(5));
+			const auto meaningful = static_cast<unsigned>(m_reader.read(6)) + 1;
+			m_trailing = static_cast<std::uint8_t>(64 - m_leading - meaningful);
+		}
+		m_value ^= m_reader.read(64u - m_leading - m_trailing) << m_trailing;
+	}
+
+	return true;
+}
+
+inline std::int64_t deye::detail::gorilla::block_decoder::time() const
+{
+	return m_time;
+}
+
+inline std::uint64_t deye::detail::gorilla::block_decoder::value() const
+{
+	return m_value;
+}
+
+//--------------[ history ]--------------//
+
+inline deye::history::history(const history_config config) :
+	m_config{ config }
+{
+	m_config.block_size = std::max(m_config.block_size, std::uint32_t{ 1 });
+	m_config.block_count = std::max(m_config.block_count, std::uint32_t{ 1 });
+}
+
+template<deye::detail::tcp_socket Socket>
+std::error_code deye::history::poll(connector<Socket>& connector, std::span<const config::sensor_id> sensor_ids)
+{
+	// Series are kept per id of `config::sensors`.
+	if (connector.sensors().data() != config::sensors.data())
+	{
+		return connector_error::make_error_code(connector_error::codes::sensor_table_mismatch);
+	}
+
+	m_values.resize(sensor_ids.size());
+
+	if (const auto error = connector.read_sensors(sensor_ids, m_values))
+	{
+		return error;
+	}
+
+	return record(clock::now(), sensor_ids, m_values);
+}
+
+inline std::error_code deye::history::record(
+	const clock::time_point time,
+	std::span<const config::sensor_id> sensor_ids,
+	std::span<const sensor_value> values
+) {
+	using connector_error::make_error_code;
+
+	if (sensor_ids.size() != values.size())
+	{
+		return make_error_code(connector_error::codes::num_sensors_values_mismatch);
+	}
+
+	auto first_error = std::error_code{};
+
+	for (std::size_t i{}; i != sensor_ids.size(); ++i)
+	{
+		if (const auto error = record(time, sensor_ids[i], values[i]); error and not first_error)
+		{
+			first_error = error;
+		}
+	}
+
+	return first_error;
+}
+
+inline std::error_code deye::history::record(
+	const clock::time_point time,
+	const config::sensor_id id,
+	const sensor_value& value
+) {
+	const auto meta = sensor_meta_by_id(id);
+	if (not meta)
+	{
+		return connector_error::make_error_code(connector_error::codes::unknown_sensor);
+	}
+
+	const auto encoded = encode_value(*meta, value);
+	if (not encoded)
+	{
+		return {};
+	}
+
+	const auto milliseconds = to_milliseconds(time);
+
+	auto& s = m_series[static_cast<std::size_t>(id)];
+
+	if (s.count != 0)
+	{
+		const auto& last = s.blocks[(s.first + s.count - 1) % s.blocks.size()];
+		if (milliseconds < last.end_time)
+		{
+			return std::make_error_code(std::errc::invalid_argument);
+		}
+	}
+
+	if (s.blocks.empty())
+	{
+		s.blocks.resize(m_config.block_count);
+	}
+
+	if (s.count == 0 or s.blocks[(s.first + s.count - 1) % s.blocks.size()].sample_count == m_config.block_size)
+	{
+		if (s.count == s.blocks.size())
+		{
+			// Drop the oldest block
+			s.first = (s.first + 1) % s.blocks.size();
+			--s.count;
+		}
+		s.blocks[(s.first + s.count) % s.blocks.size()].reset();
+		++s.count;
+	}
+
+	s.blocks[(s.first + s.count - 1) % s.blocks.size()].append(milliseconds, *encoded);
+
+	return {};
+}
+
+template<class F>
+void deye::history::for_each_sample(
+	const config::sensor_id id,
+	const std::int64_t begin,
+	const std::int64_t end,
+	F&& on_sample
+) const {
+	if (static_cast<std::size_t>(id) >= m_series.size())
+	{
+		return;
+	}
+
+	const auto& s = m_series[static_cast<std::size_t>(id)];
+
+	for (std::size_t i{}; i != s.count; ++i)
+	{
+		const auto& block = s.blocks[(s.first + i) % s.blocks.size()];
+
+		if (block.end_time < begin)
+		{
+			continue;
+		}
+
+		if (block.begin_time >= end)
+		{
+			return;
+		}
+
+		auto decoder = detail::gorilla::block_decoder{ block };
+		while (decoder.next())
+		{
+			if (decoder.time() >= end)
+			{
+				return;
+			}
+			if (decoder.time() >= begin)
+			{
+				on_sample(decoder.time(), decoder.value());
+			}
+		}
+	}
+}
+
+template<class F>
+void deye::history::query(
+	const config::sensor_id id,
+	const clock::time_point begin,
+	const clock::time_point end,
+	F&& on_sample
+) const {
+	const auto meta = sensor_meta_by_id(id);
+	if (not meta)
+	{
+		return;
+	}
+
+	for_each_sample(
+		id, to_milliseconds(begin), to_milliseconds(end),
+		[&](const std::int64_t time, const std::uint64_t value)
+		{
+			on_sample(from_milliseconds(time), decode_value(*meta, value));
+		}
+	);
+}
+
+template<class F>
+void deye::history::downsample(
+	const config::sensor_id id,
+	const clock::time_point begin,
+	const clock::time_point end,
+	const clock::duration interval,
+	F&& on_bucket
+) const {
+	const auto meta = sensor_meta_by_id(id);
+	if (not meta)
+	{
+		return;
+	}
+
+	const auto begin_time = to_milliseconds(begin);
+	const auto interval_ms = std::max(
+		std::chrono::duration_cast<std::chrono::milliseconds>(interval).count(),
+		std::int64_t{ 1 }
+	);
+
+	auto bucket_index = std::int64_t{ -1 };
+	auto bucket = history_bucket{};
+	auto sum = 0.0;
+	auto last_value = std::uint64_t{};
+
+	const auto flush = [&]()
+	{
+		if (bucket.count != 0)
+		{
+			bucket.mean = sum / static_cast<double>(bucket.count);
+			bucket.last = decode_value(*meta, last_value);
+			on_bucket(std::as_const(bucket));
+		}
+	};
+
+	for_each_sample(
+		id, begin_time, to_milliseconds(end),
+		[&](const std::int64_t time, const std::uint64_t value)
+		{
+			const auto index = (time - begin_time) / interval_ms;
+			const auto numeric = numeric_value(*meta, value);
+
+			if (index != bucket_index)
+			{
+				flush();
+				bucket_index = index;
+				bucket = history_bucket{
+					.begin = from_milliseconds(begin_time + index * interval_ms),
+					.count = 0,
+					.min = numeric,
+					.max = numeric,
+					.mean = 0.0,
+					.last = {}
+				};
+				sum = 0.0;
+			}
+
+			++bucket.count;
+			bucket.min = std::min(bucket.min, numeric);
+			bucket.max = std::max(bucket.max, numeric);
+			sum += numeric;
+			last_value = value;
+		}
+	);
+
+	flush();
+}
+
+inline std::size_t deye::history::sample_count(const config::sensor_id id) const
+{
+	if (static_cast<std::size_t>(id) >= m_series.size())
+	{
+		return 0;
+	}
+
+	const auto& s = m_series[static_cast<std::size_t>(id)];
+
+	auto count = std::size_t{};
+	for (std::size_t i{}; i != s.count; ++i)
+	{
+		count += s.blocks[(s.first + i) % s.blocks.size()].sample_count;
+	}
+
+	return count;
+}
+
+inline std::size_t deye::history::compressed_size() const
+{
+	auto size = std::size_t{};
+	for (const auto& s : m_series)
+	{
+		for (std::size_t i{}; i != s.count; ++i)
+		{
+			size += s.blocks[(s.first + i) % s.blocks.size()].words.size() * sizeof(std::uint64_t);
+		}
+	}
+	return size;
+}
+
+inline void deye::history::clear()
+{
+	for (auto& s : m_series)
+	{
+		s = {};
+	}
+}
+
+inline std::int64_t deye::history::to_milliseconds(const clock::time_point time)
+{
+	return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count();
+}
+
+inline deye::history::clock::time_point deye::history::from_milliseconds(const std::int64_t time)
+{
+	return clock::time_point{ std::chrono::duration_cast<clock::duration>(std::chrono::milliseconds{ time }) };
+}
+
+inline std::optional<std::uint64_t> deye::history::encode_value(const sensor_meta& meta, const sensor_value& value)
+{
+	if (value.type() != meta.rep.type())
+	{
+		return std::nullopt;
+	}
+
+	switch (value.type())
+	{
+	case sensor_value_rep_id::integer:
+		return std::bit_cast<std::uint64_t>(value.get<sensor_value::integer>()->value);
+	case sensor_value_rep_id::physical:
+		return std::bit_cast<std::uint64_t>(value.get<sensor_value::physical>()->value);
+	case sensor_value_rep_id::enumeration:
+		return static_cast<std::uint64_t>(value.get<sensor_value::enumeration>()->index);
+	default:
+		return std::nullopt;
+	}
+}
+
+inline deye::sensor_value deye::history::decode_value(const sensor_meta& meta, const std::uint64_t value)
+{
+	switch (meta.rep.type())
+	{
+	case sensor_value_rep_id::integer:
+		return { sensor_value::integer{ .value = std::bit_cast<std::int64_t>(value) } };
+	case sensor_value_rep_id::physical:
+		return {
+			sensor_value::physical{
+				.value = std::bit_cast<double>(value),
+				.unit_id = meta.rep.get<sensor_value_rep::physical>()->unit_id
+			}
+		};
+	case sensor_value_rep_id::enumeration:
+		return {
+			sensor_value::enumeration{
+				.index = static_cast<std::size_t>(value),
+				.enum_id = meta.rep.get<sensor_value_rep::enumeration>()->enum_id
+			}
+		};
+	default:
+		return {};
+	}
+}
+
+inline double deye::history::numeric_value(const sensor_meta& meta, const std::uint64_t value)
+{
+	switch (meta.rep.type())
+	{
+	case sensor_value_rep_id::integer:
+		return static_cast<double>(std::bit_cast<std::int64_t>(value));
+	case sensor_value_rep_id::physical:
+		return std::bit_cast<double>(value);
+	default:
+		return static_cast<double>(value);
+	}
+}
@@ -0,0 +1,445 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <bit>
+#include <vector>
+
+namespace deye
+{
+
+namespace detail::name_lookup
+{
+
+struct key
+{
+	std::string_view name;
+	// Separates keys that share a name, like the same state name in different enumerations.
+	std::uint64_t salt;
+};
+
+// FNV-1a over the name, seeded with the salt.
+[[nodiscard]] constexpr std::uint64_t hash(std::string_view name, std::uint64_t salt);
+
+[[nodiscard]] constexpr std::size_t bucket_count_for(std::size_t key_count);
+[[nodiscard]] constexpr std::size_t slot_count_for(std::size_t key_count);
+
+[[nodiscard]] constexpr std::size_t bucket_of(std::uint64_t hash, std::size_t bucket_count);
+[[nodiscard]] constexpr std::size_t slot_of(std::uint64_t hash, std::uint16_t displacement, std::size_t slot_count);
+
+/**
+ * @brief Builds a collision free hash table by hash and displace, at compile time or at runtime.
+ *
+ * Every key's hash picks a bucket and the bucket's displacement picks the key's slot,
+ * so a lookup is two array accesses and one string comparison.
+ *
+ * @param displacements Receives the displacement of every bucket, sized `bucket_count_for(hashes.size())`.
+ * @param slots Receives the index of every key plus one, sized `slot_count_for(hashes.size())`. Zero marks an empty slot.
+ *
+ * @return Whether every key got a slot of its own, which fails for duplicate keys.
+ */
+[[nodiscard]] constexpr bool place_keys(
+	std::span<const std::uint64_t> hashes,
+	std::span<std::uint16_t> displacements,
+	std::span<std::uint16_t> slots
+);
+
+// The index of the only key that can have this hash, the caller compares the names.
+[[nodiscard]] constexpr std::optional<std::size_t> candidate(
+	std::uint64_t hash,
+	std::span<const std::uint16_t> displacements,
+	std::span<const std::uint16_t> slots
+);
+
+template<std::size_t KeyCount>
+struct perfect_hash_table
+{
+	std::array<std::uint16_t, bucket_count_for(KeyCount)> displacements{};
+	std::array<std::uint16_t, slot_count_for(KeyCount)> slots{};
+	bool complete{ false };
+};
+
+template<std::size_t KeyCount>
+[[nodiscard]] consteval perfect_hash_table<KeyCount> make_perfect_hash_table(const std::array<key, KeyCount>& keys);
+
+} // namespace detail::name_lookup
+
+/**
+ * @brief The runtime counterpart of `sensor_id_by_name` for sensor tables loaded at runtime.
+ *
+ * Uses the same kind of table as the built-in lookups, so both cost the same.
+ */
+class sensor_name_index
+{
+public:
+	sensor_name_index() = default;
+
+	/**
+	 * @param sensors Has to outlive the index.
+	 *
+	 * @return The index or `connector_error::codes::invalid_profile` if two sensors share a name.
+	 */
+	[[nodiscard]] static std::expected<sensor_name_index, std::error_code> build(std::span<const sensor_meta> sensors);
+
+	[[nodiscard]] std::optional<config::sensor_id> find(std::string_view name) const;
+
+private:
+	std::span<const sensor_meta> m_sensors{};
+	std::vector<std::uint16_t> m_displacements{}, m_slots{};
+};
+
+/**
+ * @brief Looks up a sensor by its name in `config::sensors`, for example "Battery SOC".
+ */
+[[nodiscard]] constexpr std::optional<config::sensor_id> sensor_id_by_name(std::string_view name);
+
+/**
+ * @brief Looks up a physical unit by its name or symbol, for example "watts" or "W".
+ */
+[[nodiscard]] constexpr std::optional<config::physical_unit_id> physical_unit_id_by_name(std::string_view name);
+
+/**
+ * @brief Looks up the index of a state of an enumeration by its name, for example "Enable" of `time_of_use`.
+ */
+[[nodiscard]] constexpr std::optional<std::size_t> enumeration_index_by_name(
+	config::enumeration_id enum_id,
+	std::string_view name
+);
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+constexpr std::uint64_t deye::detail::name_lookup::hash(const std::string_view name, const std::uint64_t salt)
+{
+	auto h = std::uint64_t{ 0xcbf29ce484222325 } ^ (salt * 0x9e3779b97f4a7c15);
+	for (const auto c : name)
+	{
+		h ^= static_cast<std::uint8_t>(c);
+		h *= 0x100000001b3;
+	}
+	return h;
+}
+
+constexpr std::size_t deye::detail::name_lookup::bucket_count_for(const std::size_t key_count)
+{
+	return key_count / 2 + 1;
+}
+
+constexpr std::size_t deye::detail::name_lookup::slot_count_for(const std::size_t key_count)
+{
+	return std::bit_ceil(key_count + key_count / 2 + 1);
+}
+
+constexpr std::size_t deye::detail::name_lookup::bucket_of(const std::uint64_t hash, const std::size_t bucket_count)
+{
+	return static_cast<std::size_t>(hash >> 32) % bucket_count;
+}
+
+constexpr std::size_t deye::detail::name_lookup::slot_of(
+	const std::uint64_t hash,
+	const std::uint16_t displacement,
+	const std::size_t slot_count
+) {
+	// splitmix64 finalizer, so every displacement scatters the keys of a bucket anew.
+	auto z = hash + displacement * std::uint64_t{ 0x9e3779b97f4a7c15 };
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return static_cast<std::size_t>(z ^ (z >> 31)) & (slot_count - 1);
+}
+
+constexpr bool deye::detail::name_lookup::place_keys(
+	std::span<const std::uint64_t> hashes,
+	std::span<std::uint16_t> displacements,
+	std::span<std::uint16_t> slots
+) {
+	const auto bucket_size = [&](const std::size_t b)
+	{
+		return static_cast<std::size_t>(std::ranges::count_if(
+			hashes,
+			[&](const std::uint64_t hash) { return bucket_of(hash, displacements.size()) == b; }
+		));
+	};
+
+	const auto place_bucket = [&](const std::size_t b)
+	{
+		for (std::uint32_t displacement{}; displacement != 0x10000; ++displacement)
+		{
+			const auto d = static_cast<std::uint16_t>(displacement);
+
+			auto placed = true;
+			for (std::size_t i{}; i != hashes.size() and placed; ++i)
+			{
+				if (bucket_of(hashes[i], displacements.size()) != b)
+				{
+					continue;
+				}
+
+				auto& slot = slots[slot_of(hashes[i], d, slots.size())];
+				placed = slot == 0;
+				if (placed)
+				{
+					slot = static_cast<std::uint16_t>(i + 1);
+				}
+			}
+
+			if (placed)
+			{
+				displacements[b] = d;
+				return true;
+			}
+
+			// Take back the keys this displacement already placed.
+			for (std::size_t i{}; i != hashes.size(); ++i)
+			{
+				auto& slot = slots[slot_of(hashes[i], d, slots.size())];
+				if (bucket_of(hashes[i], displacements.size()) == b and slot == i + 1)
+				{
+					slot = 0;
+				}
+			}
+		}
+
+		return false;
+	};
+
+	std::ranges::fill(displacements, 0);
+	std::ranges::fill(slots, 0);
+
+	// Large buckets are placed first, while the table still has plenty of free slots.
+	auto largest_bucket = std::size_t{};
+	for (std::size_t b{}; b != displacements.size(); ++b)
+	{
+		largest_bucket = std::max(largest_bucket, bucket_size(b));
+	}
+
+	for (auto size = largest_bucket; size != 0; --size)
+	{
+		for (std::size_t b{}; b != displacements.size(); ++b)
+		{
+			if (bucket_size(b) == size and not place_bucket(b))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+constexpr std::optional<std::size_t> deye::detail::name_lookup::candidate(
+	const std::uint64_t hash,
+	std::span<const std::uint16_t> displacements,
+	std::span<const std::uint16_t> slots
+) {
+	const auto displacement = displacements[bucket_of(hash, displacements.size())];
+	const auto entry = slots[slot_of(hash, displacement, slots.size())];
+	if (entry == 0)
+	{
+		return std::nullopt;
+	}
+	return entry - 1;
+}
+
+template<std::size_t KeyCount>
+consteval deye::detail::name_lookup::perfect_hash_table<KeyCount> deye::detail::name_lookup::make_perfect_hash_table(
+	const std::array<key, KeyCount>& keys
+) {
+	auto hashes = std::array<std::uint64_t, KeyCount>{};
+	for (std::size_t i{}; i != KeyCount; ++i)
+	{
+		hashes[i] = hash(keys[i].name, keys[i].salt);
+	}
+
+	auto table = perfect_hash_table<KeyCount>{};
+	table.complete = place_keys(hashes, table.displacements, table.slots);
+
+	return table;
+}
+
+namespace deye::detail::name_lookup
+{
+
+inline constexpr auto sensor_keys = []
+{
+	auto keys = std::array<key, config::sensors.size()>{};
+	for (std::size_t i{}; i != keys.size(); ++i)
+	{
+		keys[i] = { config::sensors[i].name, 0 };
+	}
+	return keys;
+}();
+
+// The names of all units followed by their symbols.
+inline constexpr auto physical_unit_keys = []
+{
+	constexpr auto unit_count = config::physical_units.size();
+
+	auto keys = std::array<key, 2 * unit_count>{};
+	for (std::size_t i{}; i != unit_count; ++i)
+	{
+		keys[i] = { config::physical_units[i].name, 0 };
+		keys[unit_count + i] = { config::physical_units[i].symbol, 0 };
+	}
+	return keys;
+}();
+
+struct enumeration_state
+{
+	config::enumeration_id enum_id;
+	std::size_t index;
+};
+
+inline constexpr auto enumeration_state_count = []
+{
+	auto count = std::size_t{};
+	for (const auto& names : config::enumerations)
+	{
+		count += names.size();
+	}
+	return count;
+}();
+
+// The states of all enumerations, salted with their enumeration id.
+inline constexpr auto enumeration_states = []
+{
+	auto states = std::array<enumeration_state, enumeration_state_count>{};
+	auto keys = std::array<key, enumeration_state_count>{};
+
+	auto i = std::size_t{};
+	for (std::size_t e{}; e != config::enumerations.size(); ++e)
+	{
+		for (std::size_t index{}; index != config::enumerations[e].size(); ++index, ++i)
+		{
+			states[i] = { static_cast<config::enumeration_id>(e), index };
+			keys[i] = { config::enumerations[e][index], e };
+		}
+	}
+	return std::pair{ states, keys };
+}();
+
+inline constexpr auto sensor_table = make_perfect_hash_table(sensor_keys);
+inline constexpr auto physical_unit_table = make_perfect_hash_table(physical_unit_keys);
+inline constexpr auto enumeration_table = make_perfect_hash_table(enumeration_states.second);
+
+static_assert(sensor_table.complete, "Sensor names collide in the perfect hash table, are they unique?");
+static_assert(physical_unit_table.complete, "Unit names and symbols collide in the perfect hash table, are they unique?");
+static_assert(enumeration_table.complete, "Enumeration states collide in the perfect hash table, are they unique?");
+
+// Finds the key of `name` in a table built from `keys`.
+template<std::size_t KeyCount>
+[[nodiscard]] constexpr std::optional<std::size_t> find(
+	const perfect_hash_table<KeyCount>& table,
+	const std::array<key, KeyCount>& keys,
+	const std::string_view name,
+	const std::uint64_t salt
+) {
+	const auto index = candidate(hash(name, salt), table.displacements, table.slots);
+	if (not index or keys[*index].name != name or keys[*index].salt != salt)
+	{
+		return std::nullopt;
+	}
+	return index;
+}
+
+} // namespace deye::detail::name_lookup
+
+constexpr std::optional<deye::config::sensor_id> deye::sensor_id_by_name(const std::string_view name)
+{
+	using namespace detail::name_lookup;
+
+	return find(sensor_table, sensor_keys, name, 0).transform(
+		[](const std::size_t index) { return static_cast<config::sensor_id>(index); }
+	);
+}
+
+constexpr std::optional<deye::config::physical_unit_id> deye::physical_unit_id_by_name(const std::string_view name)
+{
+	using namespace detail::name_lookup;
+
+	return find(physical_unit_table, physical_unit_keys, name, 0).transform(
+		[](const std::size_t index)
+		{
+			return static_cast<config::physical_unit_id>(index % config::physical_units.size());
+		}
+	);
+}
+
+constexpr std::optional<std::size_t> deye::enumeration_index_by_name(
+	const config::enumeration_id enum_id,
+	const std::string_view name
+) {
+	using namespace detail::name_lookup;
+
+	const auto& [states, keys] = enumeration_states;
+
+	return find(enumeration_table, keys, name, static_cast<std::uint64_t>(enum_id)).transform(
+		[&](const std::size_t index) { return states[index].index; }
+	);
+}
+
+inline std::expected<deye::sensor_name_index, std::error_code> deye::sensor_name_index::build(
+	std::span<const sensor_meta> sensors
+) {
+	using namespace detail::name_lookup;
+
+	auto index = sensor_name_index{};
+	index.m_sensors = sensors;
+	index.m_displacements.resize(bucket_count_for(sensors.size()));
+	index.m_slots.resize(slot_count_for(sensors.size()));
+
+	auto hashes = std::vector<std::uint64_t>(sensors.size());
+	for (std::size_t i{}; i != sensors.size(); ++i)
+	{
+		hashes[i] = hash(sensors[i].name, 0);
+	}
+
+	if (
+		sensors.size() >= std::numeric_limits<std::uint16_t>::max() or
+		not place_keys(hashes, index.m_displacements, index.m_slots)
+	) {
+		return std::unexpected{ connector_error::make_error_code(connector_error::codes::invalid_profile) };
+	}
+
+	return index;
+}
+
+inline std::optional<deye::config::sensor_id> deye::sensor_name_index::find(const std::string_view name) const
+{
+	using namespace detail::name_lookup;
+
+	if (m_sensors.empty())
+	{
+		return std::nullopt;
+	}
+
+	const auto index = candidate(hash(name, 0), m_displacements, m_slots);
+	if (not index or m_sensors[*index].name != name)
+	{
+		return std::nullopt;
+	}
+
+	return static_cast<config::sensor_id>(*index);
+}
+
+static_assert(
+	[]
+	{
+		for (std::size_t i{}; i != deye::config::sensors.size(); ++i)
+		{
+			if (deye::sensor_id_by_name(deye::config::sensors[i].name) != static_cast<deye::config::sensor_id>(i))
+			{
+				return false;
+			}
+		}
+		return not deye::sensor_id_by_name("Battery S0C") and not deye::sensor_id_by_name("");
+	}(),
+	"Sensor name lookup does not match the sensor table."
+);
@@ -0,0 +1,524 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+#include "deye_names.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace deye
+{
+
+/**
+ * @brief A sensor table loaded at runtime, for inverter models whose registers differ from `config::sensors`.
+ *
+ * Profiles are written as text, one sensor per line:
+ *
+ * ```
+ * # name, begin address, register count, representation, parameters
+ * Inverter ID, 3, 5, registers
+ * Control Board Version No., 13, 1, integer, <scale>, <offset>
+ * Battery SOC, 184, 1, physical, <scale>, <offset>, <unit name or symbol>
+ * Running Status, 59, 1, enumeration, <enumeration id>
+ * ```
+ *
+ * The sensors are sorted by address into the same flat `sensor_meta` table as `config::sensors`,
+ * so a connector given `sensors()` plans and decodes exactly as fast as with the built-in table.
+ * Sensor ids index into that sorted table. Units and enumerations refer to the built-in ones.
+ * `serialize` produces a binary form that loads without parsing the text again.
+ */
+class register_profile
+{
+public:
+	/**
+	 * @return The profile or `connector_error::codes::invalid_profile` if a line is malformed.
+	 */
+	[[nodiscard]] static std::expected<register_profile, std::error_code> parse(std::string_view text);
+
+	[[nodiscard]] static std::expected<register_profile, std::error_code> deserialize(std::span<const std::uint8_t> data);
+
+	[[nodiscard]] std::vector<std::uint8_t> serialize() const;
+
+	/**
+	 * @brief Loads a profile in either form, the binary form is recognized by its magic number.
+	 */
+	[[nodiscard]] static std::expected<register_profile, std::error_code> load(const char* path);
+
+	// Saves the binary form.
+	[[nodiscard]] std::error_code save(const char* path) const;
+
+	// Valid as long as the profile, moving the profile keeps it valid.
+	[[nodiscard]] std::span<const sensor_meta> sensors() const;
+
+	[[nodiscard]] std::optional<config::sensor_id> sensor_id_by_name(std::string_view name) const;
+
+private:
+	// A sensor whose name is still an offset into the name storage.
+	struct entry
+	{
+		std::uint32_t name_offset;
+		std::uint16_t name_size;
+		std::uint16_t begin_address, register_count;
+		sensor_value_rep rep;
+	};
+
+	static constexpr auto magic = std::array<std::uint8_t, 8>{ 'D', 'E', 'Y', 'E', 'P', 'R', 'O', 'F' };
+	static constexpr std::uint32_t version = 1;
+
+	// magic, version, sensor count and name storage size
+	static constexpr std::size_t binary_header_size = magic.size() + 3 * sizeof(std::uint32_t);
+
+	// name offset and size, begin address, register count, representation, unit or enumeration id, scale and offset
+	static constexpr std::size_t binary_entry_size = 4 + 2 + 2 + 2 + 1 + 1 + 8 + 8;
+
+	// Sorts and validates the entries and points their names into the storage.
+	[[nodiscard]] static std::expected<register_profile, std::error_code> build(
+		std::string names,
+		std::vector<entry> entries
+	);
+
+	[[nodiscard]] static std::expected<sensor_value_rep, std::error_code> parse_rep(
+		std::string_view type,
+		std::span<const std::string_view> parameters
+	);
+
+	std::unique_ptr<char[]> m_names{};
+	std::size_t m_names_size{};
+	std::vector<sensor_meta> m_sensors{};
+	sensor_name_index m_index{};
+};
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+namespace deye::detail::profile
+{
+
+[[nodiscard]] inline std::string_view trim(std::string_view text)
+{
+	constexpr auto whitespace = std::string_view{ " \t\r" };
+
+	const auto begin = text.find_first_not_of(whitespace);
+	if (begin == std::string_view::npos)
+	{
+		return {};
+	}
+	return text.substr(begin, text.find_last_not_of(whitespace) - begin + 1);
+}
+
+template<typename T>
+[[nodiscard]] std::optional<T> parse_number(const std::string_view text)
+{
+	auto value = T{};
+	const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+	if (error != std::errc{} or end != text.data() + text.size())
+	{
+		return std::nullopt;
+	}
+	return value;
+}
+
+// Converting a double outside the range of the integer is undefined, so values read from a file are checked first.
+[[nodiscard]] inline std::optional<std::int32_t> to_int32(const double value)
+{
+	if (
+		not std::isfinite(value) or
+		value < std::numeric_limits<std::int32_t>::min() or
+		value > std::numeric_limits<std::int32_t>::max()
+	) {
+		return std::nullopt;
+	}
+	return static_cast<std::int32_t>(value);
+}
+
+} // namespace deye::detail::profile
+
+inline std::expected<deye::register_profile, std::error_code> deye::register_profile::parse(std::string_view text)
+{
+	using detail::profile::trim;
+	using detail::profile::parse_number;
+
+	const auto invalid = std::unexpected{ connector_error::make_error_code(connector_error::codes::invalid_profile) };
+
+	auto names = std::string{};
+	auto entries = std::vector<entry>{};
+
+	while (not text.empty())
+	{
+		const auto line_end = std::min(text.find('\n'), text.size());
+		const auto line = trim(text.substr(0, line_end));
+		text.remove_prefix(std::min(line_end + 1, text.size()));
+
+		if (line.empty() or line.front() == '#')
+		{
+			continue;
+		}
+
+		// name, begin address, register count, representation and up to three parameters
+		auto fields = std::array<std::string_view, 7>{};
+		auto field_count = std::size_t{};
+
+		for (auto rest = line;;)
+		{
+			if (field_count == fields.size())
+			{
+				return invalid;
+			}
+
+			const auto comma = std::min(rest.find(','), rest.size());
+			fields[field_count++] = trim(rest.substr(0, comma));
+			if (comma == rest.size())
+			{
+				break;
+			}
+			rest.remove_prefix(comma + 1);
+		}
+
+		if (field_count < 4)
+		{
+			return invalid;
+		}
+
+		const auto begin_address = parse_number<std::uint16_t>(fields[1]);
+		const auto register_count = parse_number<std::uint16_t>(fields[2]);
+		const auto rep = parse_rep(fields[3], std::span{ fields }.subspan(4, field_count - 4));
+
+		if (
+			fields[0].empty() or
+			fields[0].size() > std::numeric_limits<std::uint16_t>::max() or
+			not begin_address or not register_count or not rep
+		) {
+			return invalid;
+		}
+
+		entries.push_back(entry{
+			.name_offset = static_cast<std::uint32_t>(names.size()),
+			.name_size = static_cast<std::uint16_t>(fields[0].size()),
+			.begin_address = *begin_address,
+			.register_count = *register_count,
+			.rep = *rep
+		});
+		names += fields[0];
+	}
+
+	return build(std::move(names), std::move(entries));
+}
+
+inline std::expected<deye::sensor_value_rep, std::error_code> deye::register_profile::parse_rep(
+	const std::string_view type,
+	std::span<const std::string_view> parameters
+) {
+	using detail::profile::parse_number;
+
+	const auto invalid = std::unexpected{ connector_error::make_error_code(connector_error::codes::invalid_profile) };
+
+	if (type == "registers" and parameters.empty())
+	{
+		return sensor_value_rep{ sensor_value_rep::registers{} };
+	}
+
+	if (type == "integer" and parameters.size() == 2)
+	{
+		const auto scale = parse_number<std::int32_t>(parameters[0]);
+		const auto offset = parse_number<std::int32_t>(parameters[1]);
+		if (scale and offset)
+		{
+			return sensor_value_rep{ sensor_value_rep::integer{ *scale, *offset } };
+		}
+	}
+
+	if (type == "physical" and parameters.size() == 3)
+	{
+		const auto scale = parse_number<double>(parameters[0]);
+		const auto offset = parse_number<double>(parameters[1]);
+		const auto unit_id = physical_unit_id_by_name(parameters[2]);
+		if (scale and offset and unit_id)
+		{
+			return sensor_value_rep{ sensor_value_rep::physical{ *scale, *offset, *unit_id } };
+		}
+	}
+
+	if (type == "enumeration" and parameters.size() == 1)
+	{
+		const auto enum_id = parse_number<std::uint8_t>(parameters[0]);
+		if (enum_id and *enum_id < config::enumerations.size())
+		{
+			return sensor_value_rep{
+				sensor_value_rep::enumeration{ static_cast<config::enumeration_id>(*enum_id) }
+			};
+		}
+	}
+
+	return invalid;
+}
+
+inline std::expected<deye::register_profile, std::error_code> deye::register_profile::deserialize(
+	std::span<const std::uint8_t> data
+) {
+	namespace bytes = detail::bytes;
+
+	const auto invalid = std::unexpected{ connector_error::make_error_code(connector_error::codes::invalid_profile) };
+
+	if (data.size() < binary_header_size or not std::ranges::equal(data.first(magic.size()), magic))
+	{
+		return invalid;
+	}
+
+	auto offset = magic.size();
+
+	const auto file_version = bytes::to<std::uint32_t, std::endian::little>(data, &offset);
+	const auto sensor_count = bytes::to<std::uint32_t, std::endian::little>(data, &offset);
+	const auto names_size = bytes::to<std::uint32_t, std::endian::little>(data, &offset);
+
+	if (
+		not file_version or *file_version != version or
+		not sensor_count or *sensor_count > max_sensor_table_size or
+		not names_size or
+		data.size() != binary_header_size + *names_size + *sensor_count * binary_entry_size
+	) {
+		return invalid;
+	}
+
+	auto names = std::string(reinterpret_cast<const char*>(data.data() + offset), *names_size);
+	offset += *names_size;
+
+	auto entries = std::vector<entry>{};
+	entries.reserve(*sensor_count);
+
+	for (std::uint32_t i{}; i != *sensor_count; ++i)
+	{
+		// The size was checked above, so none of these reads can run out of bounds.
+		const auto name_offset = *bytes::to<std::uint32_t, std::endian::little>(data, &offset);
+		const auto name_size = *bytes::to<std::uint16_t, std::endian::little>(data, &offset);
+		const auto begin_address = *bytes::to<std::uint16_t, std::endian::little>(data, &offset);
+		const auto register_count = *bytes::to<std::uint16_t, std::endian::little>(data, &offset);
+		const auto type = *bytes::to<std::uint8_t, std::endian::little>(data, &offset);
+		const auto id = *bytes::to<std::uint8_t, std::endian::little>(data, &offset);
+		const auto scale = std::bit_cast<double>(*bytes::to<std::uint64_t, std::endian::little>(data, &offset));
+		const auto value_offset = std::bit_cast<double>(*bytes::to<std::uint64_t, std::endian::little>(data, &offset));
+
+		auto rep = std::optional<sensor_value_rep>{};
+		switch (static_cast<sensor_value_rep_id>(type))
+		{
+		case sensor_value_rep_id::registers:
+			rep = sensor_value_rep{ sensor_value_rep::registers{} };
+			break;
+		case sensor_value_rep_id::integer:
+		{
+			const auto integer_scale = detail::profile::to_int32(scale);
+			const auto integer_offset = detail::profile::to_int32(value_offset);
+			if (not integer_scale or not integer_offset)
+			{
+				return invalid;
+			}
+			rep = sensor_value_rep{ sensor_value_rep::integer{ *integer_scale, *integer_offset } };
+			break;
+		}
+		case sensor_value_rep_id::physical:
+			rep = sensor_value_rep{
+				sensor_value_rep::physical{ scale, value_offset, static_cast<config::physical_unit_id>(id) }
+			};
+			break;
+		case sensor_value_rep_id::enumeration:
+			rep = sensor_value_rep{ sensor_value_rep::enumeration{ static_cast<config::enumeration_id>(id) } };
+			break;
+		default:
+			return invalid;
+		}
+
+		entries.push_back(entry{
+			.name_offset = name_offset,
+			.name_size = name_size,
+			.begin_address = begin_address,
+			.register_count = register_count,
+			.rep = *rep
+		});
+	}
+
+	return build(std::move(names), std::move(entries));
+}
+
+inline std::vector<std::uint8_t> deye::register_profile::serialize() const
+{
+	namespace bytes = detail::bytes;
+
+	const auto names = std::string_view{ m_names.get(), m_names_size };
+
+	auto data = std::vector<std::uint8_t>(binary_header_size + names.size() + m_sensors.size() * binary_entry_size);
+	auto offset = std::size_t{};
+
+	// The buffer is sized to fit, so none of these writes can fail.
+	[[maybe_unused]] auto failed = (
+		bytes::from<std::uint8_t , std::endian::little>(magic			, data, &offset) or
+		bytes::from<std::uint32_t, std::endian::little>(version		, data, &offset) or
+		bytes::from<std::uint32_t, std::endian::little>(m_sensors.size(), data, &offset) or
+		bytes::from<std::uint32_t, std::endian::little>(names.size()	, data, &offset)
+	);
+
+	std::ranges::copy(names, data.begin() + static_cast<std::ptrdiff_t>(offset));
+	offset += names.size();
+
+	for (const auto& sensor : m_sensors)
+	{
+		auto id = std::uint8_t{};
+		auto scale = 0.0, value_offset = 0.0;
+
+		if (const auto integer = sensor.rep.get<sensor_value_rep::integer>())
+		{
+			scale = integer->scale;
+			value_offset = integer->offset;
+		}
+		else if (const auto physical = sensor.rep.get<sensor_value_rep::physical>())
+		{
+			scale = physical->scale;
+			value_offset = physical->offset;
+			id = static_cast<std::uint8_t>(physical->unit_id);
+		}
+		else if (const auto enumeration = sensor.rep.get<sensor_value_rep::enumeration>())
+		{
+			id = static_cast<std::uint8_t>(enumeration->enum_id);
+		}
+
+		failed = (
+			bytes::from<std::uint32_t, std::endian::little>(sensor.name.data() - m_names.get()		, data, &offset) or
+			bytes::from<std::uint16_t, std::endian::little>(sensor.name.size()						, data, &offset) or
+			bytes::from<std::uint16_t, std::endian::little>(sensor.begin_address					, data, &offset) or
+			bytes::from<std::uint16_t, std::endian::little>(sensor.register_count					, data, &offset) or
+			bytes::from<std::uint8_t , std::endian::little>(static_cast<std::uint8_t>(sensor.rep.type()), data, &offset) or
+			bytes::from<std::uint8_t , std::endian::little>(id										, data, &offset) or
+			bytes::from<std::uint64_t, std::endian::little>(std::bit_cast<std::uint64_t>(scale)		, data, &offset) or
+			bytes::from<std::uint64_t, std::endian::little>(std::bit_cast<std::uint64_t>(value_offset), data, &offset)
+		);
+	}
+
+	return data;
+}
+
+inline std::expected<deye::register_profile, std::error_code> deye::register_profile::load(const char* path)
+{
+	const auto file = std::unique_ptr<std::FILE, decltype(&std::fclose)>{ std::fopen(path, "rb"), &std::fclose };
+	if (not file)
+	{
+		return std::unexpected{ std::error_code{ errno, std::generic_category() } };
+	}
+
+	auto data = std::vector<std::uint8_t>{};
+	auto chunk = std::array<std::uint8_t, 4096>{};
+
+	while (const auto size = std::fread(chunk.data(), 1, chunk.size(), file.get()))
+	{
+		data.insert(data.end(), chunk.begin(), chunk.begin() + static_cast<std::ptrdiff_t>(size));
+	}
+
+	if (std::ferror(file.get()))
+	{
+		return std::unexpected{ std::make_error_code(std::errc::io_error) };
+	}
+
+	if (data.size() >= magic.size() and std::ranges::equal(std::span{ data }.first(magic.size()), magic))
+	{
+		return deserialize(data);
+	}
+
+	return parse(std::string_view{ reinterpret_cast<const char*>(data.data()), data.size() });
+}
+
+inline std::error_code deye::register_profile::save(const char* path) const
+{
+	const auto data = serialize();
+
+	const auto file = std::unique_ptr<std::FILE, decltype(&std::fclose)>{ std::fopen(path, "wb"), &std::fclose };
+	if (not file)
+	{
+		return { errno, std::generic_category() };
+	}
+
+	if (std::fwrite(data.data(), 1, data.size(), file.get()) != data.size() or std::fflush(file.get()) != 0)
+	{
+		return std::make_error_code(std::errc::io_error);
+	}
+
+	return {};
+}
+
+inline std::span<const deye::sensor_meta> deye::register_profile::sensors() const
+{
+	return m_sensors;
+}
+
+inline std::optional<deye::config::sensor_id> deye::register_profile::sensor_id_by_name(const std::string_view name) const
+{
+	return m_index.find(name);
+}
+
+inline std::expected<deye::register_profile, std::error_code> deye::register_profile::build(
+	std::string names,
+	std::vector<entry> entries
+) {
+	const auto invalid = std::unexpected{ connector_error::make_error_code(connector_error::codes::invalid_profile) };
+
+	if (entries.size() > max_sensor_table_size)
+	{
+		return invalid;
+	}
+
+	// Sensors that share an address keep the order they were listed in.
+	std::ranges::stable_sort(entries, {}, &entry::begin_address);
+
+	auto profile = register_profile{};
+	profile.m_names = std::make_unique<char[]>(names.size());
+	std::ranges::copy(names, profile.m_names.get());
+	profile.m_names_size = names.size();
+
+	profile.m_sensors.reserve(entries.size());
+
+	for (const auto& e : entries)
+	{
+		// `interpret` reads numeric values from at most four registers.
+		const auto max_register_count = e.rep.type() == sensor_value_rep_id::registers
+			? sensor_value::registers::max_size
+			: sizeof(std::uint64_t) / sizeof(std::uint16_t);
+
+		const auto physical = e.rep.get<sensor_value_rep::physical>();
+		const auto enumeration = e.rep.get<sensor_value_rep::enumeration>();
+
+		if (
+			static_cast<std::size_t>(e.name_offset) + e.name_size > names.size() or
+			e.register_count == 0 or e.register_count > max_register_count or
+			e.begin_address + e.register_count > 0x10000 or
+			(physical and physical->unit_id >= config::physical_unit_id::COUNT) or
+			(physical and not (std::isfinite(physical->scale) and std::isfinite(physical->offset))) or
+			(enumeration and enumeration->enum_id >= config::enumeration_id::COUNT)
+		) {
+			return invalid;
+		}
+
+		profile.m_sensors.push_back(sensor_meta{
+			.name = std::string_view{ profile.m_names.get() + e.name_offset, e.name_size },
+			.begin_address = e.begin_address,
+			.register_count = e.register_count,
+			.rep = e.rep
+		});
+	}
+
+	auto index = sensor_name_index::build(profile.m_sensors);
+	if (not index)
+	{
+		return std::unexpected{ index.error() };
+	}
+	profile.m_index = std::move(*index);
+
+	return profile;
+}
@@ -0,0 +1,293 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <thread>
+#include <vector>
+
+namespace deye
+{
+
+struct scheduler_config
+{
+	// Sensors that become due within this fraction of their interval are read early with the due ones,
+	// so sensors of similar intervals end up sharing their reads.
+	double early_fraction{ 0.25 };
+
+	// Intervals are stretched when a read takes longer than this fraction of the shortest stretched interval
+	// or when a sensor missed a whole interval. They shrink back once reads take less than half of it.
+	double max_busy_fraction{ 0.5 };
+
+	// The factor intervals are stretched or shrunk by per tick and the upper limit of the total stretch.
+	double stretch_step{ 1.5 };
+	double max_stretch{ 16.0 };
+};
+
+struct scheduler_stats
+{
+	std::uint64_t ticks{}, reads{}, sensors_read{}, errors{};
+	double stretch{ 1.0 };
+};
+
+/**
+ * @brief Polls every sensor at its own interval.
+ *
+ * All sensors that are due on a tick are read with one `read_sensors` call,
+ * so the read planner merges their registers into the fewest frames.
+ * When the logger can't keep up all intervals are stretched by a common factor.
+ */
+class poll_scheduler
+{
+public:
+	using clock = std::chrono::steady_clock;
+
+	explicit poll_scheduler(scheduler_config config = {});
+
+	/**
+	 * @brief Schedules a sensor, the first read happens on the next tick.
+	 *
+	 * @param interval The time between reads, zero reads the sensor only once.
+	 */
+	[[nodiscard]] std::error_code schedule(config::sensor_id id, clock::duration interval);
+
+	[[nodiscard]] std::error_code unschedule(config::sensor_id id);
+
+	// The time the next sensor is due or `std::nullopt` if no sensor is scheduled.
+	[[nodiscard]] std::optional<clock::time_point> next_due() const;
+
+	/**
+	 * @brief Reads the sensors that are due and calls `on_values(sensor_ids, values)` with the result.
+	 *
+	 * Sensors of a failed read stay due and are retried on the next tick.
+	 *
+	 * @return `connector_error::codes::sensor_table_mismatch` if the connector uses another table than `config::sensors`.
+	 */
+	template<detail::tcp_socket Socket, class F>
+	[[nodiscard]] std::error_code tick(connector<Socket>& connector, F&& on_values);
+
+	// Calls `tick` whenever a sensor is due until a read fails.
+	template<detail::tcp_socket Socket, class F>
+	[[nodiscard]] std::error_code run(connector<Socket>& connector, F&& on_values);
+
+	[[nodiscard]] const scheduler_stats& stats() const;
+
+private:
+	struct entry
+	{
+		clock::duration interval{};
+		clock::time_point due{};
+		bool scheduled{ false };
+	};
+
+	[[nodiscard]] clock::duration stretched(clock::duration interval) const;
+
+	// Stretches the intervals when the logger is overloaded and shrinks them back when it is idle.
+	void adapt(bool overloaded, bool idle);
+
+	scheduler_config m_config;
+	std::array<entry, config::sensors.size()> m_entries{};
+	std::vector<config::sensor_id> m_due_ids{};
+	std::vector<sensor_value> m_values{};
+	scheduler_stats m_stats{};
+};
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+inline deye::poll_scheduler::poll_scheduler(const scheduler_config config) :
+	m_config{ config }
+{
+	m_config.stretch_step = std::max(m_config.stretch_step, 1.0);
+	m_config.max_stretch = std::max(m_config.max_stretch, 1.0);
+}
+
+inline std::error_code deye::poll_scheduler::schedule(const config::sensor_id id, const clock::duration interval)
+{
+	const auto index = static_cast<std::size_t>(id);
+	if (index >= m_entries.size())
+	{
+		return connector_error::make_error_code(connector_error::codes::unknown_sensor);
+	}
+
+	m_entries[index] = entry{
+		.interval = interval,
+		.due = clock::time_point::min(),
+		.scheduled = true
+	};
+
+	return {};
+}
+
+inline std::error_code deye::poll_scheduler::unschedule(const config::sensor_id id)
+{
+	const auto index = static_cast<std::size_t>(id);
+	if (index >= m_entries.size())
+	{
+		return connector_error::make_error_code(connector_error::codes::unknown_sensor);
+	}
+
+	m_entries[index].scheduled = false;
+
+	return {};
+}
+
+inline std::optional<deye::poll_scheduler::clock::time_point> deye::poll_scheduler::next_due() const
+{
+	auto due = std::optional<clock::time_point>{};
+
+	for (const auto& e : m_entries)
+	{
+		if (e.scheduled and (not due or e.due < *due))
+		{
+			due = e.due;
+		}
+	}
+
+	return due;
+}
+
+template<deye::detail::tcp_socket Socket, class F>
+std::error_code deye::poll_scheduler::tick(connector<Socket>& connector, F&& on_values)
+{
+	// Intervals are scheduled by the ids of `config::sensors`.
+	if (connector.sensors().data() != config::sensors.data())
+	{
+		return connector_error::make_error_code(connector_error::codes::sensor_table_mismatch);
+	}
+
+	const auto now = clock::now();
+
+	++m_stats.ticks;
+
+	m_due_ids.clear();
+	auto missed_interval = false;
+	auto shortest_interval = clock::duration::max();
+
+	for (std::size_t i{}; i != m_entries.size(); ++i)
+	{
+		const auto& e = m_entries[i];
+		if (not e.scheduled)
+		{
+			continue;
+		}
+
+		const auto interval = stretched(e.interval);
+		const auto early = std::chrono::duration_cast<clock::duration>(interval * m_config.early_fraction);
+
+		if (e.due <= now + early)
+		{
+			m_due_ids.push_back(static_cast<config::sensor_id>(i));
+			// Sensors that have never been read can't have missed anything.
+			if (e.interval != clock::duration::zero() and e.due != clock::time_point::min())
+			{
+				missed_interval |= now - e.due >= interval;
+			}
+		}
+
+		if (e.interval != clock::duration::zero())
+		{
+			shortest_interval = std::min(shortest_interval, interval);
+		}
+	}
+
+	if (m_due_ids.empty())
+	{
+		return {};
+	}
+
+	m_values.resize(m_due_ids.size());
+
+	const auto error = connector.read_sensors(m_due_ids, m_values);
+	const auto read_time = clock::now() - now;
+
+	if (error)
+	{
+		++m_stats.errors;
+		if (error == connector_error::codes::operation_timed_out)
+		{
+			adapt(true, false);
+		}
+		return error;
+	}
+
+	++m_stats.reads;
+	m_stats.sensors_read += m_due_ids.size();
+
+	for (const auto id : m_due_ids)
+	{
+		auto& e = m_entries[static_cast<std::size_t>(id)];
+
+		if (e.interval == clock::duration::zero())
+		{
+			e.scheduled = false;
+			continue;
+		}
+
+		const auto interval = stretched(e.interval);
+
+		// Keep the phase of the sensor unless it fell behind.
+		e.due = e.due == clock::time_point::min() ? now + interval : e.due + interval;
+		if (e.due <= now)
+		{
+			e.due = now + interval;
+		}
+	}
+
+	if (shortest_interval != clock::duration::max())
+	{
+		const auto busy_limit = std::chrono::duration_cast<clock::duration>(
+			shortest_interval * m_config.max_busy_fraction
+		);
+		adapt(missed_interval or read_time >= busy_limit, read_time * 2 < busy_limit);
+	}
+
+	on_values(std::span<const config::sensor_id>{ m_due_ids }, std::span<const sensor_value>{ m_values });
+
+	return {};
+}
+
+template<deye::detail::tcp_socket Socket, class F>
+std::error_code deye::poll_scheduler::run(connector<Socket>& connector, F&& on_values)
+{
+	while (const auto due = next_due())
+	{
+		std::this_thread::sleep_until(*due);
+
+		if (const auto error = tick(connector, on_values))
+		{
+			return error;
+		}
+	}
+
+	return {};
+}
+
+inline const deye::scheduler_stats& deye::poll_scheduler::stats() const
+{
+	return m_stats;
+}
+
+inline deye::poll_scheduler::clock::duration deye::poll_scheduler::stretched(const clock::duration interval) const
+{
+	return std::chrono::duration_cast<clock::duration>(interval * m_stats.stretch);
+}
+
+inline void deye::poll_scheduler::adapt(const bool overloaded, const bool idle)
+{
+	if (overloaded)
+	{
+		m_stats.stretch = std::min(m_stats.stretch * m_config.stretch_step, m_config.max_stretch);
+	}
+	else if (idle)
+	{
+		m_stats.stretch = std::max(m_stats.stretch / m_config.stretch_step, 1.0);
+	}
+}
@@ -0,0 +1,496 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace deye
+{
+
+namespace detail
+{
+
+struct mpsc_node
+{
+	std::atomic<mpsc_node*> next{ nullptr };
+};
+
+/**
+ * @brief Intrusive multi producer single consumer queue (Vyukov).
+ *
+ * `push` is wait free and may be called from any thread, `pop` may only be called from one thread at a time.
+ * `pop` can miss a node whose `push` is still in progress, the producer has to signal the consumer afterwards.
+ */
+class mpsc_queue
+{
+public:
+	inline mpsc_queue();
+
+	mpsc_queue(const mpsc_queue&) = delete;
+	mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+	inline void push(mpsc_node* node);
+
+	[[nodiscard]] inline mpsc_node* pop();
+
+private:
+	std::atomic<mpsc_node*> m_head;
+	mpsc_node* m_tail;
+	mpsc_node m_stub{};
+};
+
+} // namespace detail
+
+struct shared_connector_stats
+{
+	std::uint64_t requests{}, batches{}, errors{};
+};
+
+/**
+ * @brief Thread safe front end of a `connector` that coalesces concurrent reads.
+ *
+ * Callers hand their requests to an I/O thread through a lock free queue and get their result through a future.
+ * The I/O thread reads all requests that are queued at the same time with one `read_sensors` call,
+ * so overlapping and neighbouring sensors of different callers share their frames.
+ * The connection is established on the first request and reestablished after errors.
+ */
+template<detail::tcp_socket Socket>
+class shared_connector
+{
+public:
+	using sensor_result = std::expected<sensor_value, std::error_code>;
+	using sensors_result = std::expected<std::vector<sensor_value>, std::error_code>;
+
+	shared_connector(
+		std::string host,
+		std::uint16_t port,
+		serial_number_type serial_number,
+		read_plan_config read_plan = {},
+		timeout_config timeouts = {}
+	);
+
+	shared_connector(const shared_connector&) = delete;
+	shared_connector& operator=(const shared_connector&) = delete;
+
+	[[nodiscard]] std::future<sensor_result> read_sensor(config::sensor_id id);
+
+	/**
+	 * @return The values in the order of `sensor_ids` or the error of the combined read.
+	 */
+	[[nodiscard]] std::future<sensors_result> read_sensors(std::span<const config::sensor_id> sensor_ids);
+
+	/**
+	 * @brief Stops the I/O thread, requests that have not been read yet fail with `std::errc::operation_canceled`.
+	 */
+	void stop();
+
+	[[nodiscard]] shared_connector_stats stats() const;
+
+	~shared_connector();
+
+private:
+	struct request : detail::mpsc_node
+	{
+		std::vector<config::sensor_id> sensor_ids;
+		std::variant<std::promise<sensor_result>, std::promise<sensors_result>> promise;
+	};
+
+	void enqueue(std::unique_ptr<request> req);
+
+	void run();
+
+	void read_batch(std::span<const std::unique_ptr<request>> batch);
+
+	static void complete(request& req, std::span<const sensor_value> values, std::span<const std::size_t> value_indices);
+
+	static void fail(request& req, std::error_code error);
+
+	[[nodiscard]] static std::error_code validate(std::span<const config::sensor_id> sensor_ids);
+
+	std::string m_host;
+	std::uint16_t m_port;
+	connector<Socket> m_connector;
+	bool m_connected{ false };
+
+	detail::mpsc_queue m_queue{};
+	std::atomic<std::uint64_t> m_signal{ 0 };
+	std::atomic<bool> m_running{ true };
+
+	// Producers between their running check and their push, `stop` waits for them before the final drain.
+	std::atomic<std::size_t> m_enqueuing{ 0 };
+
+	std::atomic<std::uint64_t> m_requests{ 0 }, m_batches{ 0 }, m_errors{ 0 };
+
+	std::thread m_thread;
+};
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+//--------------[ mpsc queue ]--------------//
+
+inline deye::detail::mpsc_queue::mpsc_queue() :
+	m_head{ &m_stub },
+	m_tail{ &m_stub }
+{}
+
+inline void deye::detail::mpsc_queue::push(mpsc_node* node)
+{
+	node->next.store(nullptr, std::memory_order_relaxed);
+	const auto previous = m_head.exchange(node, std::memory_order_acq_rel);
+	previous->next.store(node, std::memory_order_release);
+}
+
+inline deye::detail::mpsc_node* deye::detail::mpsc_queue::pop()
+{
+	auto tail = m_tail;
+	auto next = tail->next.load(std::memory_order_acquire);
+
+	if (tail == &m_stub)
+	{
+		if (next == nullptr)
+		{
+			return nullptr;
+		}
+		m_tail = next;
+		tail = next;
+		next = next->next.load(std::memory_order_acquire);
+	}
+
+	if (next != nullptr)
+	{
+		m_tail = next;
+		return tail;
+	}
+
+	if (tail != m_head.load(std::memory_order_acquire))
+	{
+		// A producer has swapped the head but not linked its node yet.
+		return nullptr;
+	}
+
+	// `tail` is the last node, the stub takes its place so it can be handed out.
+	push(&m_stub);
+
+	next = tail->next.load(std::memory_order_acquire);
+	if (next != nullptr)
+	{
+		m_tail = next;
+		return tail;
+	}
+
+	return nullptr;
+}
+
+//--------------[ shared connector ]--------------//
+
+template<deye::detail::tcp_socket Socket>
+deye::shared_connector<Socket>::shared_connector(
+	std::string host,
+	const std::uint16_t port,
+	const serial_number_type serial_number,
+	const read_plan_config read_plan,
+	const timeout_config timeouts
+) :
+	m_host{ std::move(host) },
+	m_port{ port },
+	m_connector{ serial_number }
+{
+	m_connector.read_plan() = read_plan;
+	m_connector.set_timeouts(timeouts);
+	m_thread = std::thread(&shared_connector::run, this);
+}
+
+template<deye::detail::tcp_socket Socket>
+std::future<typename deye::shared_connector<Socket>::sensor_result> deye::shared_connector<Socket>::read_sensor(
+	const config::sensor_id id
+) {
+	auto req = std::make_unique<request>();
+	req->sensor_ids.push_back(id);
+
+	auto& promise = req->promise.template emplace<std::promise<sensor_result>>();
+	auto future = promise.get_future();
+
+	enqueue(std::move(req));
+
+	return future;
+}
+
+template<deye::detail::tcp_socket Socket>
+std::future<typename deye::shared_connector<Socket>::sensors_result> deye::shared_connector<Socket>::read_sensors(
+	std::span<const config::sensor_id> sensor_ids
+) {
+	auto req = std::make_unique<request>();
+	req->sensor_ids.assign(sensor_ids.begin(), sensor_ids.end());
+
+	auto& promise = req->promise.template emplace<std::promise<sensors_result>>();
+	auto future = promise.get_future();
+
+	if (sensor_ids.empty())
+	{
+		promise.set_value(std::vector<sensor_value>{});
+		return future;
+	}
+
+	enqueue(std::move(req));
+
+	return future;
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::shared_connector<Socket>::enqueue(std::unique_ptr<request> req)
+{
+	if (const auto error = validate(req->sensor_ids))
+	{
+		fail(*req, error);
+		return;
+	}
+
+	// Sequentially consistent together with `stop`, so either this sees the stop or `stop` sees this producer.
+	m_enqueuing.fetch_add(1);
+
+	if (not m_running.load())
+	{
+		m_enqueuing.fetch_sub(1, std::memory_order_release);
+		fail(*req, std::make_error_code(std::errc::operation_canceled));
+		return;
+	}
+
+	m_requests.fetch_add(1, std::memory_order_relaxed);
+
+	// The queue owns the request until the I/O thread pops it.
+	m_queue.push(req.release());
+
+	m_signal.fetch_add(1, std::memory_order_release);
+	m_signal.notify_one();
+
+	// Last, `stop` may return and the connector be destroyed right after.
+	m_enqueuing.fetch_sub(1, std::memory_order_release);
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::shared_connector<Socket>::run()
+{
+	auto batch = std::vector<std::unique_ptr<request>>{};
+
+	while (true)
+	{
+		const auto signal = m_signal.load(std::memory_order_acquire);
+
+		batch.clear();
+		while (const auto node = m_queue.pop())
+		{
+			batch.emplace_back(static_cast<request*>(node));
+		}
+
+		if (not m_running.load(std::memory_order_acquire))
+		{
+			for (auto& req : batch)
+			{
+				fail(*req, std::make_error_code(std::errc::operation_canceled));
+			}
+			break;
+		}
+
+		if (batch.empty())
+		{
+			m_signal.wait(signal, std::memory_order_acquire);
+			continue;
+		}
+
+		read_batch(batch);
+	}
+
+	if (m_connected)
+	{
+		[[maybe_unused]] const auto error = m_connector.disconnect();
+		m_connected = false;
+	}
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::shared_connector<Socket>::read_batch(std::span<const std::unique_ptr<request>> batch)
+{
+	m_batches.fetch_add(1, std::memory_order_relaxed);
+
+	// Combine the sensors of all requests, the read planner merges them into ranges.
+	auto requested = std::array<bool, config::sensors.size()>{};
+	for (const auto& req : batch)
+	{
+		for (const auto id : req->sensor_ids)
+		{
+			requested[static_cast<std::size_t>(id)] = true;
+		}
+	}
+
+	auto sensor_ids = std::array<config::sensor_id, config::sensors.size()>{};
+	auto value_indices = std::array<std::size_t, config::sensors.size()>{};
+	auto sensor_count = std::size_t{};
+
+	for (std::size_t i{}; i != requested.size(); ++i)
+	{
+		if (requested[i])
+		{
+			value_indices[i] = sensor_count;
+			sensor_ids[sensor_count++] = static_cast<config::sensor_id>(i);
+		}
+	}
+
+	auto values = std::array<sensor_value, config::sensors.size()>{};
+
+	auto error = std::error_code{};
+
+	if (not m_connected)
+	{
+		error = m_connector.connect(m_host.c_str(), m_port);
+		m_connected = not error;
+	}
+
+	if (not error)
+	{
+		error = m_connector.read_sensors(
+			std::span{ sensor_ids }.first(sensor_count),
+			std::span{ values }.first(sensor_count)
+		);
+	}
+
+	if (error)
+	{
+		m_errors.fetch_add(1, std::memory_order_relaxed);
+
+		if (m_connected)
+		{
+			// Start the next batch with a fresh connection, the stream may be out of sync.
+			[[maybe_unused]] const auto disconnect_error = m_connector.disconnect();
+			m_connected = false;
+		}
+
+		for (const auto& req : batch)
+		{
+			fail(*req, error);
+		}
+		return;
+	}
+
+	for (const auto& req : batch)
+	{
+		complete(*req, values, value_indices);
+	}
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::shared_connector<Socket>::complete(
+	request& req,
+	std::span<const sensor_value> values,
+	std::span<const std::size_t> value_indices
+) {
+	const auto value_of = [&](const config::sensor_id id) -> const sensor_value&
+	{
+		return values[value_indices[static_cast<std::size_t>(id)]];
+	};
+
+	std::visit(
+		detail::overloaded_lambda{
+			[&](std::promise<sensor_result>& promise)
+			{
+				promise.set_value(value_of(req.sensor_ids.front()));
+			},
+			[&](std::promise<sensors_result>& promise)
+			{
+				auto slice = std::vector<sensor_value>{};
+				slice.reserve(req.sensor_ids.size());
+				for (const auto id : req.sensor_ids)
+				{
+					slice.push_back(value_of(id));
+				}
+				promise.set_value(std::move(slice));
+			}
+		},
+		req.promise
+	);
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::shared_connector<Socket>::fail(request& req, const std::error_code error)
+{
+	std::visit(
+		[&](auto& promise)
+		{
+			promise.set_value(std::unexpected{ error });
+		},
+		req.promise
+	);
+}
+
+template<deye::detail::tcp_socket Socket>
+std::error_code deye::shared_connector<Socket>::validate(std::span<const config::sensor_id> sensor_ids)
+{
+	for (const auto id : sensor_ids)
+	{
+		if (static_cast<std::size_t>(id) >= config::sensors.size())
+		{
+			return connector_error::make_error_code(connector_error::codes::unknown_sensor);
+		}
+	}
+
+	return {};
+}
+
+template<deye::detail::tcp_socket Socket>
+void deye::shared_connector<Socket>::stop()
+{
+	if (not m_running.exchange(false))
+	{
+		return;
+	}
+
+	m_signal.fetch_add(1, std::memory_order_release);
+	m_signal.notify_one();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	// Producers that passed the running check before the stop are at most a push away from being done.
+	while (m_enqueuing.load() != 0)
+	{
+		std::this_thread::yield();
+	}
+
+	// Their requests may have arrived after the I/O thread's last pop.
+	while (const auto node = m_queue.pop())
+	{
+		const auto req = std::unique_ptr<request>{ static_cast<request*>(node) };
+		fail(*req, std::make_error_code(std::errc::operation_canceled));
+	}
+}
+
+template<deye::detail::tcp_socket Socket>
+deye::shared_connector_stats deye::shared_connector<Socket>::stats() const
+{
+	return {
+		.requests = m_requests.load(std::memory_order_relaxed),
+		.batches = m_batches.load(std::memory_order_relaxed),
+		.errors = m_errors.load(std::memory_order_relaxed)
+	};
+}
+
+template<deye::detail::tcp_socket Socket>
+deye::shared_connector<Socket>::~shared_connector()
+{
+	stop();
+}
@@ -0,0 +1,496 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace deye
+{
+
+struct simulator_faults
+{
+	// Added before every response, the jitter is drawn uniformly from [0, jitter].
+	std::chrono::microseconds latency{}, jitter{};
+
+	// Probability that a response is sent in two writes split at a random byte.
+	double partial_write_probability{};
+
+	// Probability that a request is answered with an error frame instead of its response.
+	double error_frame_probability{};
+
+	// The status code of injected error frames,
+	// 0x0005 (device address mismatch) or 0x0006 (serial number mismatch).
+	std::uint16_t error_frame_code{ 0x0006 };
+};
+
+struct simulator_stats
+{
+	std::uint64_t requests{}, reads{}, writes{}, error_frames{}, partial_writes{};
+};
+
+/**
+ * @brief Plays the logger side of the Solarman V5 protocol from an in-memory register map.
+ *
+ * Answers `0x0103` reads and `0x0110` writes as produced by `connector::send_modbus_frame`.
+ * The register map is seeded so that every sensor of `config::sensors` decodes to a valid value.
+ * Requests for another serial number are answered with the `0x0006` error frame like a real logger does.
+ */
+class simulator
+{
+public:
+	static constexpr std::size_t buffer_size = 2048;
+
+	explicit simulator(serial_number_type serial_number, simulator_faults faults = {}, std::uint32_t seed = 5489);
+
+	/**
+	 * @brief Returns the size of the request frame starting with `header`.
+	 *
+	 * @param header At least the first `detail::modbus::header_size` bytes of a request frame.
+	 */
+	[[nodiscard]] static std::expected<std::size_t, std::error_code> request_size(std::span<const std::uint8_t> header);
+
+	/**
+	 * @brief Validates a complete request frame and builds its response, injecting error frames.
+	 *
+	 * @return The response frame, valid until the next call.
+	 */
+	[[nodiscard]] std::expected<std::span<const std::uint8_t>, std::error_code> respond(std::span<const std::uint8_t> request);
+
+	/**
+	 * @brief Answers the requests of a connected socket until receiving or sending fails,
+	 * injecting latency, jitter and partial writes.
+	 *
+	 * @return The error that ended the connection, usually the client disconnecting.
+	 */
+	template<detail::tcp_socket Socket>
+	[[nodiscard]] std::error_code serve(Socket& socket);
+
+	[[nodiscard]] std::span<std::uint16_t> registers();
+	[[nodiscard]] std::span<const std::uint16_t> registers() const;
+
+	[[nodiscard]] serial_number_type& serial_number();
+	[[nodiscard]] const serial_number_type& serial_number() const;
+
+	[[nodiscard]] simulator_faults& faults();
+	[[nodiscard]] const simulator_faults& faults() const;
+
+	[[nodiscard]] const simulator_stats& stats() const;
+
+private:
+	[[nodiscard]] bool draw(double probability);
+
+	[[nodiscard]] std::span<const std::uint8_t> encode_error_frame(
+		std::uint8_t sequence_number,
+		serial_number_type serial_number,
+		std::uint16_t code
+	);
+
+	template<class F>
+	[[nodiscard]] std::expected<std::span<const std::uint8_t>, std::error_code> encode_response_frame(
+		std::uint8_t sequence_number,
+		std::size_t data_size,
+		F&& write_response
+	);
+
+	[[nodiscard]] std::expected<std::span<const std::uint8_t>, std::error_code> respond_modbus(
+		std::uint8_t sequence_number,
+		std::span<const std::uint8_t> request
+	);
+
+	std::vector<std::uint16_t> m_registers;
+	serial_number_type m_serial_number;
+	simulator_faults m_faults;
+	simulator_stats m_stats{};
+	std::mt19937 m_random;
+	std::uint8_t m_own_sequence_number{};
+	std::array<std::uint8_t, buffer_size> m_request{}, m_response{};
+};
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+inline deye::simulator::simulator(
+	const serial_number_type serial_number,
+	const simulator_faults faults,
+	const std::uint32_t seed
+) :
+	m_registers(0x10000),
+	m_serial_number{ serial_number },
+	m_faults{ faults },
+	m_random{ seed }
+{
+	for (std::size_t i{}; i != config::sensors.size(); ++i)
+	{
+		const auto& sensor = config::sensors[i];
+		const auto registers = std::span{ m_registers }.subspan(sensor.begin_address, sensor.register_count);
+
+		switch (sensor.rep.type())
+		{
+		case sensor_value_rep_id::registers:
+			std::iota(registers.begin(), registers.end(), sensor.begin_address);
+			break;
+		case sensor_value_rep_id::enumeration:
+			// The first name is always valid.
+			std::ranges::fill(registers, 0);
+			break;
+		default:
+			// Small distinct values that stay in range for every scale.
+			std::ranges::fill(registers, 0);
+			registers.front() = static_cast<std::uint16_t>(i + 1);
+			break;
+		}
+	}
+}
+
+inline std::expected<std::size_t, std::error_code> deye::simulator::request_size(std::span<const std::uint8_t> header)
+{
+	using namespace detail::modbus;
+	namespace bytes = detail::bytes;
+
+	if (header.size() < header_size)
+	{
+		return std::unexpected{ make_error_code(connector_error::codes::internal_error) };
+	}
+
+	if (header.front() != 0xa5 or bytes::to<std::uint16_t, std::endian::little>(header, 3) != 0x4510)
+	{
+		return std::unexpected{ std::make_error_code(std::errc::bad_message) };
+	}
+
+	const auto payload_size = bytes::to<std::uint16_t, std::endian::little>(header, 1);
+	if (not payload_size)
+	{
+		return std::unexpected{ payload_size.error() };
+	}
+
+	return header_size + *payload_size + trailer_size;
+}
+
+inline std::expected<std::span<const std::uint8_t>, std::error_code> deye::simulator::respond(
+	std::span<const std::uint8_t> request
+) {
+	using namespace detail::modbus;
+	namespace bytes = detail::bytes;
+
+	const auto frame_size = request_size(request);
+	if (not frame_size)
+	{
+		return std::unexpected{ frame_size.error() };
+	}
+
+	// The smallest request carries an empty modbus request and its crc.
+	if (
+		*frame_size != request.size() or
+		request.size() < header_size + request_data_field_size + sizeof(std::uint16_t) + trailer_size or
+		request.back() != 0x15
+	) {
+		return std::unexpected{ std::make_error_code(std::errc::bad_message) };
+	}
+
+	static constexpr auto ignore_start_byte = sizeof(std::uint8_t);
+	if (checksum(request.subspan(ignore_start_byte, request.size() - ignore_start_byte - trailer_size)) != request[request.size() - trailer_size])
+	{
+		return std::unexpected{ std::make_error_code(std::errc::bad_message) };
+	}
+
+	const auto modbus_begin = header_size + request_data_field_size;
+	const auto modbus_request = request.subspan(modbus_begin, request.size() - modbus_begin - sizeof(std::uint16_t) - trailer_size);
+
+	if (crc(modbus_request) != bytes::to<std::uint16_t, std::endian::little>(request, request.size() - trailer_size - sizeof(std::uint16_t)))
+	{
+		return std::unexpected{ std::make_error_code(std::errc::bad_message) };
+	}
+
+	++m_stats.requests;
+
+	const auto sequence_number = request[5];
+	const auto requested_serial_number = *bytes::to<serial_number_type, std::endian::little>(request, 7);
+
+	if (requested_serial_number != m_serial_number)
+	{
+		++m_stats.error_frames;
+		return encode_error_frame(sequence_number, requested_serial_number, 0x0006);
+	}
+
+	if (draw(m_faults.error_frame_probability))
+	{
+		++m_stats.error_frames;
+		return encode_error_frame(sequence_number, m_serial_number, m_faults.error_frame_code);
+	}
+
+	return respond_modbus(sequence_number, modbus_request);
+}
+
+inline std::expected<std::span<const std::uint8_t>, std::error_code> deye::simulator::respond_modbus(
+	const std::uint8_t sequence_number,
+	std::span<const std::uint8_t> request
+) {
+	namespace bytes = detail::bytes;
+
+	const auto function = bytes::to<std::uint16_t, std::endian::big>(request, std::size_t{ 0 });
+	const auto begin_address = bytes::to<std::uint16_t, std::endian::big>(request, 2);
+	const auto register_count = bytes::to<std::uint16_t, std::endian::big>(request, 4);
+
+	const auto valid_range = (
+		begin_address and register_count and
+		*register_count != 0 and
+		*begin_address + *register_count <= m_registers.size()
+	);
+
+	// Everything that isn't a valid read or write gets the modbus exception for an illegal data address.
+	const auto exception = [&]()
+	{
+		return encode_response_frame(sequence_number, 3, [&](std::span<std::uint8_t> res)
+		{
+			res[0] = request.size() > 0 ? request[0] : 0x01;
+			res[1] = static_cast<std::uint8_t>((request.size() > 1 ? request[1] : 0x00) | 0x80);
+			res[2] = 0x02;
+		});
+	};
+
+	if (function == 0x0103)
+	{
+		if (request.size() != detail::modbus::read_request_size or not valid_range or *register_count > 125)
+		{
+			return exception();
+		}
+
+		++m_stats.reads;
+
+		const auto registers = std::span{ m_registers }.subspan(*begin_address, *register_count);
+
+		return encode_response_frame(sequence_number, 3 + registers.size_bytes(), [&](std::span<std::uint8_t> res)
+		{
+			res[0] = 0x01;
+			res[1] = 0x03;
+			res[2] = static_cast<std::uint8_t>(registers.size_bytes());
+			[[maybe_unused]] const auto error = bytes::from<std::uint16_t, std::endian::big>(registers, res, 3);
+		});
+	}
+
+	if (function == 0x0110)
+	{
+		const auto byte_count = bytes::to<std::uint8_t, std::endian::big>(request, 6);
+
+		if (
+			not valid_range or not byte_count or
+			*byte_count != *register_count * sizeof(std::uint16_t) or
+			request.size() != 7u + *byte_count
+		) {
+			return exception();
+		}
+
+		++m_stats.writes;
+
+		for (std::size_t i{}; i != *register_count; ++i)
+		{
+			m_registers[*begin_address + i] = *bytes::to<std::uint16_t, std::endian::big>(request, 7 + i * sizeof(std::uint16_t));
+		}
+
+		// Echoes function, address and register count.
+		return encode_response_frame(sequence_number, 6, [&](std::span<std::uint8_t> res)
+		{
+			std::copy_n(request.begin(), 6, res.begin());
+		});
+	}
+
+	return exception();
+}
+
+template<class F>
+std::expected<std::span<const std::uint8_t>, std::error_code> deye::simulator::encode_response_frame(
+	const std::uint8_t sequence_number,
+	const std::size_t data_size,
+	F&& write_response
+) {
+	using namespace detail::modbus;
+	namespace bytes = detail::bytes;
+
+	const auto frame_size = read_response_frame_size(0) - 3 + data_size;
+	if (frame_size > m_response.size())
+	{
+		return std::unexpected{ make_error_code(connector_error::codes::action_exceeds_local_buffer_size) };
+	}
+
+	auto frame = std::span{ m_response }.first(frame_size);
+	std::ranges::fill(frame, 0);
+
+	auto offset = std::size_t{};
+
+	if (std::error_code error;
+		((error = bytes::from<std::uint8_t		, std::endian::little>(0xa5						, frame, &offset))) or // start byte
+		((error = bytes::from<std::uint16_t		, std::endian::little>(frame_size - header_size - trailer_size, frame, &offset))) or // payload size
+		((error = bytes::from<std::uint16_t		, std::endian::little>(0x1510					, frame, &offset))) or // control code
+		((error = bytes::from<std::uint8_t		, std::endian::little>(sequence_number			, frame, &offset))) or // echoed sequence number
+		((error = bytes::from<std::uint8_t		, std::endian::little>(m_own_sequence_number++	, frame, &offset))) or // own sequence number
+		((error = bytes::from<serial_number_type, std::endian::little>(m_serial_number			, frame, &offset))) or // serial number
+		((error = bytes::from<std::uint8_t		, std::endian::little>(0x02						, frame, &offset)))    // frame type, rest of the data field stays zero
+	) {
+		return std::unexpected{ error };
+	}
+
+	offset = header_size + response_data_field_size;
+
+	const auto data = frame.subspan(offset, data_size);
+	write_response(data);
+	offset += data_size;
+
+	if (const auto error = bytes::from<std::uint16_t, std::endian::little>(crc(data), frame, &offset))
+	{
+		return std::unexpected{ error };
+	}
+
+	frame[offset] = checksum(frame.subspan(1, offset - 1));
+	frame[offset + 1] = 0x15;
+
+	return frame;
+}
+
+inline std::span<const std::uint8_t> deye::simulator::encode_error_frame(
+	const std::uint8_t sequence_number,
+	const serial_number_type serial_number,
+	const std::uint16_t code
+) {
+	using namespace detail::modbus;
+	namespace bytes = detail::bytes;
+
+	// Data field and status code without a modbus response.
+	static constexpr auto payload_size = response_data_field_size + sizeof(std::uint16_t);
+	static constexpr auto frame_size = header_size + payload_size + trailer_size;
+
+	auto frame = std::span{ m_response }.first(frame_size);
+	std::ranges::fill(frame, 0);
+
+	frame[0] = 0xa5;
+	[[maybe_unused]] auto error = bytes::from<std::uint16_t, std::endian::little>(payload_size, frame, 1);
+	error = bytes::from<std::uint16_t, std::endian::little>(0x1510, frame, 3);
+	frame[5] = sequence_number;
+	frame[6] = m_own_sequence_number++;
+	error = bytes::from<serial_number_type, std::endian::little>(serial_number, frame, 7);
+	frame[header_size] = 0x02;
+	error = bytes::from<std::uint16_t, std::endian::little>(code, frame, header_size + response_data_field_size);
+	frame[frame_size - 2] = checksum(frame.subspan(1, frame_size - 3));
+	frame[frame_size - 1] = 0x15;
+
+	return frame;
+}
+
+template<deye::detail::tcp_socket Socket>
+std::error_code deye::simulator::serve(Socket& socket)
+{
+	using namespace detail::modbus;
+
+	while (true)
+	{
+		if (const auto error = socket.receive(std::span{ m_request }.first(header_size)))
+		{
+			return error;
+		}
+
+		const auto frame_size = request_size(m_request);
+		if (not frame_size)
+		{
+			return frame_size.error();
+		}
+
+		if (*frame_size > m_request.size())
+		{
+			return make_error_code(connector_error::codes::action_exceeds_local_buffer_size);
+		}
+
+		if (const auto error = socket.receive(std::span{ m_request }.subspan(header_size, *frame_size - header_size)))
+		{
+			return error;
+		}
+
+		const auto response = respond(std::span{ m_request }.first(*frame_size));
+		if (not response)
+		{
+			return response.error();
+		}
+
+		auto delay = m_faults.latency;
+		if (m_faults.jitter.count() > 0)
+		{
+			delay += std::chrono::microseconds{
+				std::uniform_int_distribution<std::chrono::microseconds::rep>{ 0, m_faults.jitter.count() }(m_random)
+			};
+		}
+		if (delay.count() > 0)
+		{
+			std::this_thread::sleep_for(delay);
+		}
+
+		auto bytes_left = *response;
+
+		if (draw(m_faults.partial_write_probability))
+		{
+			++m_stats.partial_writes;
+
+			const auto split = std::uniform_int_distribution<std::size_t>{ 1, bytes_left.size() - 1 }(m_random);
+			if (const auto error = socket.send(bytes_left.first(split)))
+			{
+				return error;
+			}
+			bytes_left = bytes_left.subspan(split);
+
+			// Give the first part time to leave as its own segment.
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+		}
+
+		if (const auto error = socket.send(bytes_left))
+		{
+			return error;
+		}
+	}
+}
+
+inline bool deye::simulator::draw(const double probability)
+{
+	return probability > 0.0 and std::uniform_real_distribution<double>{}(m_random) < probability;
+}
+
+inline std::span<std::uint16_t> deye::simulator::registers()
+{
+	return m_registers;
+}
+
+inline std::span<const std::uint16_t> deye::simulator::registers() const
+{
+	return m_registers;
+}
+
+inline deye::serial_number_type& deye::simulator::serial_number()
+{
+	return m_serial_number;
+}
+
+inline const deye::serial_number_type& deye::simulator::serial_number() const
+{
+	return m_serial_number;
+}
+
+inline deye::simulator_faults& deye::simulator::faults()
+{
+	return m_faults;
+}
+
+inline const deye::simulator_faults& deye::simulator::faults() const
+{
+	return m_faults;
+}
+
+inline const deye::simulator_stats& deye::simulator::stats() const
+{
+	return m_stats;
+}
@@ -0,0 +1,210 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_connector.hpp"
+
+#include <vector>
+
+namespace deye
+{
+
+/**
+ * @brief An image of every register a sensor table covers, read in frame sized chunks.
+ *
+ * One `read` per cycle fetches the whole configured address space, gaps shorter than a frame are read along.
+ * Afterwards any subset of sensors, including the ones that alias the same registers,
+ * is decoded from the image without further io, so many consumers can share one read.
+ */
+class register_snapshot
+{
+public:
+	using clock = std::chrono::system_clock;
+
+	/**
+	 * @param sensors The sensor table the image covers, sorted by address like every sensor table. Has to outlive the snapshot.
+	 * @param max_registers_per_frame The chunk size, same as `read_plan_config::max_registers_per_frame`.
+	 */
+	explicit register_snapshot(
+		std::span<const sensor_meta> sensors = config::sensors,
+		std::uint16_t max_registers_per_frame = read_plan_config{}.max_registers_per_frame
+	);
+
+	/**
+	 * @brief Reads all chunks into the image, on failure the previous image is kept.
+	 */
+	template<detail::tcp_socket Socket>
+	[[nodiscard]] std::error_code read(connector<Socket>& connector);
+
+	/**
+	 * @brief Decodes the given sensors from the image.
+	 */
+	[[nodiscard]] std::error_code decode(std::span<const config::sensor_id> sensor_ids, std::span<sensor_value> values) const;
+
+	[[nodiscard]] std::expected<sensor_value, std::error_code> decode(config::sensor_id id) const;
+
+	/**
+	 * @brief The indices of the sensors that begin within `range`, found by binary search over the address sorted table.
+	 *
+	 * @return The half open range `[first, last)` of sensor indices.
+	 */
+	[[nodiscard]] std::pair<std::size_t, std::size_t> sensors_in(const register_range& range) const;
+
+	// The chunks one `read` requests in ascending order.
+	[[nodiscard]] std::span<const register_range> chunks() const;
+
+	// The image, element zero holds the register at `begin_address`.
+	// Gaps between sensors that were read along hold live values, only registers outside every chunk stay zero.
+	[[nodiscard]] std::span<const std::uint16_t> registers() const;
+	[[nodiscard]] std::uint16_t begin_address() const;
+
+	// The time of the last successful read or `std::nullopt` if there was none.
+	[[nodiscard]] std::optional<clock::time_point> read_time() const;
+
+private:
+	std::span<const sensor_meta> m_sensors;
+	std::vector<register_range> m_chunks{};
+	std::vector<std::uint16_t> m_image{}, m_scratch{};
+	std::uint16_t m_begin_address{};
+	std::optional<clock::time_point> m_read_time{};
+};
+
+} // namespace deye
+
+
+//====================[ implementations ]====================//
+
+inline deye::register_snapshot::register_snapshot(
+	const std::span<const sensor_meta> sensors,
+	const std::uint16_t max_registers_per_frame
+) :
+	m_sensors{ sensors }
+{
+	if (m_sensors.empty())
+	{
+		return;
+	}
+
+	// Any gap shorter than a frame costs less to read along than a new chunk would.
+	const auto plan = read_plan_config{
+		.max_registers_per_frame = max_registers_per_frame,
+		.round_trip_cost = max_registers_per_frame
+	};
+
+	[[maybe_unused]] const auto error = detail::read_planner::for_each_range(
+		m_sensors,
+		[](std::size_t) { return true; },
+		plan,
+		[&](const register_range& range) -> std::error_code
+		{
+			m_chunks.push_back(range);
+			return {};
+		}
+	);
+
+	// Sorted by begin address, the last sensor doesn't necessarily end last.
+	auto end_address = std::size_t{};
+	for (const auto& sensor : m_sensors)
+	{
+		end_address = std::max(end_address, static_cast<std::size_t>(sensor.begin_address) + sensor.register_count);
+	}
+
+	m_begin_address = m_sensors.front().begin_address;
+	m_image.resize(end_address - m_begin_address);
+}
+
+template<deye::detail::tcp_socket Socket>
+std::error_code deye::register_snapshot::read(connector<Socket>& connector)
+{
+	// Chunks arrive one after another, so a failed read must not leave a half updated image behind.
+	m_scratch = m_image;
+
+	if (const auto error = connector.read_register_image(m_chunks, m_begin_address, m_scratch))
+	{
+		return error;
+	}
+
+	std::swap(m_image, m_scratch);
+	m_read_time = clock::now();
+
+	return {};
+}
+
+inline std::error_code deye::register_snapshot::decode(
+	std::span<const config::sensor_id> sensor_ids,
+	std::span<sensor_value> values
+) const {
+	if (sensor_ids.size() != values.size())
+	{
+		return connector_error::make_error_code(connector_error::codes::num_sensors_values_mismatch);
+	}
+
+	for (std::size_t i{}; i != sensor_ids.size(); ++i)
+	{
+		if (auto value = decode(sensor_ids[i]))
+		{
+			values[i] = std::move(*value);
+		}
+		else
+		{
+			return value.error();
+		}
+	}
+
+	return {};
+}
+
+inline std::expected<deye::sensor_value, std::error_code> deye::register_snapshot::decode(const config::sensor_id id) const
+{
+	const auto index = static_cast<std::size_t>(id);
+	if (index >= m_sensors.size())
+	{
+		return std::unexpected{ connector_error::make_error_code(connector_error::codes::unknown_sensor) };
+	}
+
+	const auto& sensor = m_sensors[index];
+
+	return sensor.rep.interpret(
+		std::span{ m_image }.subspan(sensor.begin_address - m_begin_address, sensor.register_count)
+	);
+}
+
+inline std::pair<std::size_t, std::size_t> deye::register_snapshot::sensors_in(const register_range& range) const
+{
+	const auto end_address = static_cast<std::size_t>(range.begin_address) + range.register_count;
+
+	const auto first = std::ranges::lower_bound(m_sensors, range.begin_address, {}, &sensor_meta::begin_address);
+	const auto last = std::ranges::lower_bound(
+		first, m_sensors.end(), end_address, {},
+		[](const sensor_meta& sensor) { return static_cast<std::size_t>(sensor.begin_address); }
+	);
+
+	return {
+		static_cast<std::size_t>(first - m_sensors.begin()),
+		static_cast<std::size_t>(last - m_sensors.begin())
+	};
+}
+
+inline std::span<const deye::register_range> deye::register_snapshot::chunks() const
+{
+	return m_chunks;
+}
+
+inline std::span<const std::uint16_t> deye::register_snapshot::registers() const
+{
+	return m_image;
+}
+
+inline std::uint16_t deye::register_snapshot::begin_address() const
+{
+	return m_begin_address;
+}
+
+inline std::optional<deye::register_snapshot::clock::time_point> deye::register_snapshot::read_time() const
+{
+	return m_read_time;
+}
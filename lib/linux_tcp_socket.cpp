@@ -0,0 +1,299 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#include "linux_tcp_socket.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <limits>
+#include <utility>
+
+
+static inline std::error_code make_system_error(int code) {
+	using errc_t = std::underlying_type_t<std::errc>;
+	const auto errc = static_cast<std::errc>(static_cast<errc_t>(code));
+	return std::make_error_code(errc);
+}
+
+static inline std::chrono::steady_clock::time_point make_deadline(std::chrono::milliseconds timeout) {
+	using clock = std::chrono::steady_clock;
+	return timeout.count() > 0 ? clock::now() + timeout : clock::time_point::max();
+}
+
+static inline bool would_block(int code) {
+	return code == EAGAIN or code == EWOULDBLOCK;
+}
+
+linux_tcp_socket::linux_tcp_socket(linux_tcp_socket&& other) {
+	*this = std::move(other);
+}
+
+linux_tcp_socket& linux_tcp_socket::operator=(linux_tcp_socket&& other) {
+	if (&other != this) {
+		std::swap(other.m_fd, m_fd);
+		std::swap(other.m_epoll_fd, m_epoll_fd);
+		std::swap(other.m_events, m_events);
+		m_connect_timeout = other.m_connect_timeout;
+		m_send_timeout = other.m_send_timeout;
+		m_receive_timeout = other.m_receive_timeout;
+	}
+	return *this;
+}
+
+// Takes ownership of a connected non blocking socket and registers it with the epoll instance.
+std::error_code linux_tcp_socket::adopt(int fd) {
+	int no_delay = true;
+	if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay)) != 0) {
+		const auto error = make_system_error(errno);
+		close(fd);
+		return error;
+	}
+
+	if (m_epoll_fd < 0 and (m_epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0) {
+		const auto error = make_system_error(errno);
+		close(fd);
+		return error;
+	}
+
+	// Closing a socket removes it from the epoll set, so it is added fresh on every connection.
+	epoll_event event{};
+	event.events = EPOLLOUT;
+	event.data.fd = fd;
+	if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+		const auto error = make_system_error(errno);
+		close(fd);
+		return error;
+	}
+
+	m_fd = fd;
+	m_events = event.events;
+
+	return {};
+}
+
+std::error_code linux_tcp_socket::wait_until(const std::uint32_t events, const clock::time_point deadline) {
+	if (m_events != events) {
+		epoll_event event{};
+		event.events = events;
+		event.data.fd = m_fd;
+		if (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, m_fd, &event) != 0)
+			return make_system_error(errno);
+		m_events = events;
+	}
+
+	while (true) {
+		int timeout_ms = -1;
+		if (deadline != clock::time_point::max()) {
+			const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - clock::now());
+			if (remaining.count() <= 0)
+				return std::make_error_code(std::errc::timed_out);
+			timeout_ms = static_cast<int>(std::min<std::chrono::milliseconds::rep>(
+				remaining.count(), std::numeric_limits<int>::max()
+			));
+		}
+
+		// Errors and hang ups are reported by the system call that follows.
+		epoll_event event;
+		const int ready = epoll_wait(m_epoll_fd, &event, 1, timeout_ms);
+		if (ready > 0)
+			return {};
+		if (ready == 0)
+			return std::make_error_code(std::errc::timed_out);
+		if (errno != EINTR)
+			return make_system_error(errno);
+	}
+}
+
+std::error_code linux_tcp_socket::listen(uint16_t port) {
+
+	if (m_fd >= 0) {
+		if (auto error = disconnect(); error) {
+			return error;
+		}
+	}
+
+	const int listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (listen_fd < 0)
+		return make_system_error(errno);
+
+	int conn_fd = -1;
+	{
+		int reuse_address = true;
+		if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse_address, sizeof(reuse_address)) != 0)
+			goto on_error;
+
+		sockaddr_in addr{};
+		addr.sin_family = AF_INET;
+		addr.sin_addr.s_addr = htonl(INADDR_ANY);
+		addr.sin_port = htons(port);
+
+		if (bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0)
+			goto on_error;
+
+		if (::listen(listen_fd, 1) != 0)
+			goto on_error;
+
+		do {
+			conn_fd = accept4(listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		} while (conn_fd < 0 and errno == EINTR);
+
+		if (conn_fd < 0)
+			goto on_error;
+	}
+
+	close(listen_fd);
+
+	return adopt(conn_fd);
+
+on_error:
+	const auto error = make_system_error(errno);
+	close(listen_fd);
+	return error;
+}
+
+std::error_code linux_tcp_socket::connect(const char* host, uint16_t port) {
+
+	if (m_fd >= 0) {
+		if (auto error = disconnect(); error) {
+			return error;
+		}
+	}
+
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(port);
+
+	if (int ret = inet_pton(AF_INET, host, &addr.sin_addr); ret < 1)
+		return make_system_error(ret < 0 ? errno : EINVAL);
+
+	const int conn_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (conn_fd < 0)
+		return make_system_error(errno);
+
+	const auto deadline = make_deadline(m_connect_timeout);
+
+	const bool in_progress = (
+		::connect(conn_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+	);
+
+	if (in_progress and errno != EINPROGRESS) {
+		const auto error = make_system_error(errno);
+		close(conn_fd);
+		return error;
+	}
+
+	if (auto error = adopt(conn_fd); error)
+		return error;
+
+	if (in_progress) {
+		int connect_errno = 0;
+		socklen_t len = sizeof(connect_errno);
+
+		auto error = wait_until(EPOLLOUT, deadline);
+		if (not error and getsockopt(m_fd, SOL_SOCKET, SO_ERROR, &connect_errno, &len) != 0)
+			error = make_system_error(errno);
+		if (not error and connect_errno != 0)
+			error = make_system_error(connect_errno);
+
+		if (error) {
+			[[maybe_unused]] const auto disconnect_error = disconnect();
+			return error;
+		}
+	}
+
+	return {};
+}
+
+std::error_code linux_tcp_socket::send(std::span<const uint8_t> bytes_left) {
+	const auto deadline = make_deadline(m_send_timeout);
+	while (not bytes_left.empty()) {
+		const auto sent = ::send(m_fd, bytes_left.data(), bytes_left.size(), MSG_NOSIGNAL);
+		if (sent >= 0) {
+			bytes_left = bytes_left.subspan(sent);
+			continue;
+		}
+		if (errno == EINTR)
+			continue;
+		if (not would_block(errno))
+			return make_system_error(errno);
+		if (auto error = wait_until(EPOLLOUT, deadline); error)
+			return error;
+	}
+	return {};
+}
+
+std::error_code linux_tcp_socket::receive(std::span<uint8_t> bytes_left) {
+	const auto deadline = make_deadline(m_receive_timeout);
+	while (not bytes_left.empty()) {
+		const auto received = recv(m_fd, bytes_left.data(), bytes_left.size(), 0);
+		if (received > 0) {
+			bytes_left = bytes_left.subspan(received);
+			continue;
+		}
+		if (received == 0)
+			return std::make_error_code(std::errc::connection_reset);
+		if (errno == EINTR)
+			continue;
+		if (not would_block(errno))
+			return make_system_error(errno);
+		if (auto error = wait_until(EPOLLIN, deadline); error)
+			return error;
+	}
+	return {};
+}
+
+std::expected<std::size_t, std::error_code> linux_tcp_socket::receive_some(std::span<uint8_t> data) {
+	const auto deadline = make_deadline(m_receive_timeout);
+	while (true) {
+		const auto received = recv(m_fd, data.data(), data.size(), 0);
+		if (received > 0)
+			return static_cast<std::size_t>(received);
+		if (received == 0)
+			return std::unexpected{ std::make_error_code(std::errc::connection_reset) };
+		if (errno == EINTR)
+			continue;
+		if (not would_block(errno))
+			return std::unexpected{ make_system_error(errno) };
+		if (auto error = wait_until(EPOLLIN, deadline); error)
+			return std::unexpected{ error };
+	}
+}
+
+std::error_code linux_tcp_socket::disconnect() {
+	auto error = std::error_code{};
+	if (m_fd >= 0) {
+		// A peer that already went away must not keep the socket open.
+		if (shutdown(m_fd, SHUT_RDWR) != 0 and errno != ENOTCONN)
+			error = make_system_error(errno);
+		if (close(m_fd) != 0 and not error)
+			error = make_system_error(errno);
+		m_fd = -1;
+	}
+	return error;
+}
+
+void linux_tcp_socket::set_timeouts(
+	std::chrono::milliseconds connect_timeout,
+	std::chrono::milliseconds send_timeout,
+	std::chrono::milliseconds receive_timeout
+) {
+	m_connect_timeout = connect_timeout;
+	m_send_timeout = send_timeout;
+	m_receive_timeout = receive_timeout;
+}
+
+linux_tcp_socket::~linux_tcp_socket() {
+	[[maybe_unused]] const auto error = disconnect();
+	if (m_epoll_fd >= 0) {
+		close(m_epoll_fd);
+	}
+}
@@ -0,0 +1,62 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include <system_error>
+#include <cstdint>
+#include <span>
+#include <chrono>
+#include <expected>
+
+/**
+ * @brief Dependency free socket for Linux on top of non blocking POSIX sockets.
+ *
+ * Every operation first tries the system call directly and only waits on the sockets epoll instance
+ * when the kernel would block, so a response that already arrived costs a single `recv`.
+ */
+class linux_tcp_socket {
+public:
+	linux_tcp_socket() = default;
+
+	linux_tcp_socket(linux_tcp_socket&& other);
+	linux_tcp_socket& operator=(linux_tcp_socket&& other);
+
+	linux_tcp_socket(const linux_tcp_socket& other) = delete;
+	linux_tcp_socket& operator=(const linux_tcp_socket& other) = delete;
+
+	[[nodiscard]] std::error_code listen(uint16_t port);
+
+	[[nodiscard]] std::error_code connect(const char* host, uint16_t port);
+
+	[[nodiscard]] std::error_code send(std::span<const uint8_t> data);
+
+	[[nodiscard]] std::error_code receive(std::span<uint8_t> data);
+
+	[[nodiscard]] std::expected<std::size_t, std::error_code> receive_some(std::span<uint8_t> data);
+
+	[[nodiscard]] std::error_code disconnect();
+
+	void set_timeouts(
+		std::chrono::milliseconds connect_timeout,
+		std::chrono::milliseconds send_timeout,
+		std::chrono::milliseconds receive_timeout
+	);
+
+	~linux_tcp_socket();
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	[[nodiscard]] std::error_code adopt(int fd);
+
+	[[nodiscard]] std::error_code wait_until(std::uint32_t events, clock::time_point deadline);
+
+	int m_fd{ -1 };
+	int m_epoll_fd{ -1 };
+	std::uint32_t m_events{};
+	std::chrono::milliseconds m_connect_timeout{}, m_send_timeout{}, m_receive_timeout{};
+};
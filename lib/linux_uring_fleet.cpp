@@ -0,0 +1,879 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#include "linux_uring_fleet.hpp"
+
+#include <arpa/inet.h>
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+
+static inline std::error_code make_system_error(int code) {
+	using errc_t = std::underlying_type_t<std::errc>;
+	const auto errc = static_cast<std::errc>(static_cast<errc_t>(code));
+	return std::make_error_code(errc);
+}
+
+namespace
+{
+
+using clock = std::chrono::steady_clock;
+
+// The operation of a submission is stored in the low byte of its user data, the device index above it.
+enum class operation : std::uint8_t
+{
+	connect = 1,
+	write,
+	read,
+	cancel
+};
+
+constexpr std::uint64_t make_user_data(const std::size_t index, const operation op)
+{
+	return (static_cast<std::uint64_t>(index) << 8) | static_cast<std::uint8_t>(op);
+}
+
+// Time a cancelled operation gets to complete before its socket is shut down.
+constexpr auto cancel_grace_period = std::chrono::milliseconds{ 100 };
+
+} // namespace
+
+
+//--------------[ ring ]--------------//
+
+/**
+ * @brief Minimal io_uring instance on top of the raw system calls, so the library does not depend on liburing.
+ */
+struct deye::uring_fleet::ring
+{
+	int fd{ -1 };
+	io_uring_params params{};
+
+	void* sq_map{ MAP_FAILED };
+	void* cq_map{ MAP_FAILED };
+	void* sqe_map{ MAP_FAILED };
+	std::size_t sq_map_size{}, cq_map_size{}, sqe_map_size{};
+
+	unsigned *sq_head{}, *sq_tail{}, *sq_array{};
+	unsigned *cq_head{}, *cq_tail{};
+	io_uring_sqe* sqes{};
+	io_uring_cqe* cqes{};
+	unsigned sq_mask{}, cq_mask{};
+
+	// Submissions are only published to the kernel right before entering it.
+	unsigned sq_local_tail{}, to_submit{};
+
+	[[nodiscard]] std::error_code setup(unsigned entries, unsigned cq_entries);
+
+	// Returns `nullptr` if the submission queue is full.
+	[[nodiscard]] io_uring_sqe* get_sqe();
+
+	// Submits all queued entries and waits for `min_complete` completions or the deadline.
+	[[nodiscard]] std::error_code enter(unsigned min_complete, clock::time_point deadline);
+
+	template<class F>
+	std::size_t for_each_completion(F&& on_completion);
+
+	~ring();
+};
+
+std::error_code deye::uring_fleet::ring::setup(const unsigned entries, const unsigned cq_entries)
+{
+	params.flags = IORING_SETUP_CQSIZE;
+	params.cq_entries = cq_entries;
+
+	fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+	if (fd < 0)
+	{
+		return make_system_error(errno);
+	}
+
+	// The timeout of a wait is passed through the extended argument (Linux 5.11).
+	if (not (params.features & IORING_FEAT_EXT_ARG))
+	{
+		return std::make_error_code(std::errc::function_not_supported);
+	}
+
+	sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+	if (single_mmap)
+	{
+		sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+	}
+
+	sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+	if (sq_map == MAP_FAILED)
+	{
+		return make_system_error(errno);
+	}
+
+	if (single_mmap)
+	{
+		cq_map = sq_map;
+	}
+	else
+	{
+		cq_map = mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		if (cq_map == MAP_FAILED)
+		{
+			return make_system_error(errno);
+		}
+	}
+
+	sqe_map_size = params.sq_entries * sizeof(io_uring_sqe);
+	sqe_map = mmap(nullptr, sqe_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+	if (sqe_map == MAP_FAILED)
+	{
+		return make_system_error(errno);
+	}
+
+	const auto sq_bytes = static_cast<std::uint8_t*>(sq_map);
+	const auto cq_bytes = static_cast<std::uint8_t*>(cq_map);
+
+	sq_head = reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.head);
+	sq_tail = reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.tail);
+	sq_array = reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.array);
+	sq_mask = *reinterpret_cast<unsigned*>(sq_bytes + params.sq_off.ring_mask);
+
+	cq_head = reinterpret_cast<unsigned*>(cq_bytes + params.cq_off.head);
+	cq_tail = reinterpret_cast<unsigned*>(cq_bytes + params.cq_off.tail);
+	cqes = reinterpret_cast<io_uring_cqe*>(cq_bytes + params.cq_off.cqes);
+	cq_mask = *reinterpret_cast<unsigned*>(cq_bytes + params.cq_off.ring_mask);
+
+	sqes = static_cast<io_uring_sqe*>(sqe_map);
+	sq_local_tail = *sq_tail;
+
+	return {};
+}
+
+io_uring_sqe* deye::uring_fleet::ring::get_sqe()
+{
+	const auto head = std::atomic_ref{ *sq_head }.load(std::memory_order_acquire);
+	if (sq_local_tail - head >= params.sq_entries)
+	{
+		return nullptr;
+	}
+
+	const auto index = sq_local_tail & sq_mask;
+	auto* sqe = &sqes[index];
+	std::memset(sqe, 0, sizeof(*sqe));
+	sq_array[index] = index;
+
+	++sq_local_tail;
+	++to_submit;
+
+	return sqe;
+}
+
+std::error_code deye::uring_fleet::ring::enter(const unsigned min_complete, const clock::time_point deadline)
+{
+	std::atomic_ref{ *sq_tail }.store(sq_local_tail, std::memory_order_release);
+
+	auto flags = unsigned{ IORING_ENTER_EXT_ARG };
+	if (min_complete != 0)
+	{
+		flags |= IORING_ENTER_GETEVENTS;
+	}
+
+	__kernel_timespec timeout{};
+	io_uring_getevents_arg arg{};
+	arg.sigmask_sz = _NSIG / 8;
+
+	if (min_complete != 0 and deadline != clock::time_point::max())
+	{
+		const auto remaining = std::max(deadline - clock::now(), clock::duration::zero());
+		const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(remaining);
+		timeout.tv_sec = seconds.count();
+		timeout.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(remaining - seconds).count();
+		arg.ts = reinterpret_cast<std::uint64_t>(&timeout);
+	}
+
+	const auto submitted = syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, &arg, sizeof(arg));
+	if (submitted < 0)
+	{
+		// An expired wait and a full completion queue are resolved by reaping and entering again.
+		if (errno == ETIME or errno == EINTR or errno == EBUSY or errno == EAGAIN)
+		{
+			return {};
+		}
+		return make_system_error(errno);
+	}
+
+	to_submit -= static_cast<unsigned>(submitted);
+
+	return {};
+}
+
+template<class F>
+std::size_t deye::uring_fleet::ring::for_each_completion(F&& on_completion)
+{
+	auto head = *cq_head;
+	const auto tail = std::atomic_ref{ *cq_tail }.load(std::memory_order_acquire);
+
+	const auto count = static_cast<std::size_t>(tail - head);
+
+	for (; head != tail; ++head)
+	{
+		const auto& cqe = cqes[head & cq_mask];
+		on_completion(cqe.user_data, cqe.res);
+	}
+
+	std::atomic_ref{ *cq_head }.store(head, std::memory_order_release);
+
+	return count;
+}
+
+deye::uring_fleet::ring::~ring()
+{
+	if (sqe_map != MAP_FAILED)
+	{
+		munmap(sqe_map, sqe_map_size);
+	}
+	if (cq_map != MAP_FAILED and cq_map != sq_map)
+	{
+		munmap(cq_map, cq_map_size);
+	}
+	if (sq_map != MAP_FAILED)
+	{
+		munmap(sq_map, sq_map_size);
+	}
+	if (fd >= 0)
+	{
+		::close(fd);
+	}
+}
+
+
+//--------------[ connection ]--------------//
+
+struct deye::uring_fleet::connection
+{
+	static constexpr auto frame_size = detail::modbus::request_frame_size(detail::modbus::read_request_size);
+
+	// Every range holds at least one sensor, so one request slot per sensor always suffices.
+	static constexpr auto max_ranges = config::sensors.size();
+	static_assert(max_ranges <= 256, "The ranges of a cycle need distinct sequence numbers.");
+
+	// Registered with the ring as one fixed buffer, the decoder receives in place.
+	struct frame_buffers
+	{
+		std::array<std::uint8_t, max_ranges * frame_size> send;
+		frame_decoder<2048> receive;
+	};
+
+	fleet_device info;
+	std::size_t index;
+
+	sockaddr_in address{};
+	std::vector<register_range> ranges{};
+	std::vector<sensor_value> values{};
+
+	// Set for devices that can never be polled, for example because of an unknown sensor id.
+	std::error_code config_error{};
+
+	frame_buffers buffers{};
+
+	int fd{ -1 };
+	bool connected{ false };
+
+	// State of the current poll cycle.
+	bool in_cycle{ false };
+	bool connect_in_flight{ false }, write_in_flight{ false }, read_in_flight{ false };
+	std::size_t cancels_in_flight{};
+	std::error_code error{};
+
+	// Range `i` of a cycle is requested with sequence number `first_sequence_number + i`.
+	std::uint8_t next_sequence_number{};
+	std::uint8_t first_sequence_number{};
+	std::vector<bool> received{};
+	std::size_t encoded_count{}, received_count{}, written_bytes{};
+
+	[[nodiscard]] bool busy() const
+	{
+		return connect_in_flight or write_in_flight or read_in_flight or cancels_in_flight != 0;
+	}
+};
+
+
+//--------------[ fleet ]--------------//
+
+deye::uring_fleet::uring_fleet(
+	std::vector<fleet_device> devices,
+	const read_plan_config read_plan,
+	const timeout_config timeouts
+) :
+	m_read_plan{ read_plan },
+	m_timeouts{ timeouts }
+{
+	m_connections.reserve(devices.size());
+
+	for (std::size_t i{}; i != devices.size(); ++i)
+	{
+		auto conn = std::make_unique<connection>(std::move(devices[i]), i);
+		conn->values.resize(conn->info.sensor_ids.size());
+
+		conn->address.sin_family = AF_INET;
+		conn->address.sin_port = htons(conn->info.port);
+		if (inet_pton(AF_INET, conn->info.host.c_str(), &conn->address.sin_addr) != 1)
+		{
+			conn->config_error = make_system_error(EINVAL);
+		}
+
+		if (const auto requested = detail::read_planner::requested_sensors(config::sensors, conn->info.sensor_ids))
+		{
+			[[maybe_unused]] const auto error = detail::read_planner::for_each_range(
+				config::sensors,
+				[&](const std::size_t index) { return (*requested)[index]; },
+				m_read_plan,
+				[&](const register_range& range) -> std::error_code
+				{
+					conn->ranges.push_back(range);
+					return {};
+				}
+			);
+		}
+		else
+		{
+			conn->config_error = requested.error();
+		}
+
+		conn->received.resize(conn->ranges.size());
+
+		// The ranges never change, so their frames are encoded once and every cycle only patches the sequence numbers.
+		const auto frame_template = detail::modbus::frame_template{ conn->info.serial_number };
+		for (std::size_t r{}; r != conn->ranges.size() and not conn->config_error; ++r)
+		{
+			const auto& range = conn->ranges[r];
+			const auto frame = frame_template.encode(
+				std::span{ conn->buffers.send }.subspan(r * connection::frame_size, connection::frame_size),
+				0,
+				detail::modbus::read_request_size,
+				[&](std::span<std::uint8_t> req) -> std::error_code
+				{
+					return detail::modbus::encode_read_request(req, range.begin_address, range.register_count);
+				}
+			);
+			if (not frame)
+			{
+				conn->config_error = frame.error();
+			}
+		}
+
+		m_connections.push_back(std::move(conn));
+	}
+
+	m_setup_error = setup();
+}
+
+std::error_code deye::uring_fleet::setup()
+{
+	// At most a connect, write, read and the cancellations of two of them are in flight per device.
+	const auto device_count = static_cast<unsigned>(m_connections.size());
+	const auto entries = std::bit_ceil(std::clamp(device_count * 2, 8U, 4096U));
+	const auto cq_entries = std::bit_ceil(std::max(device_count * 4, entries));
+
+	m_ring = std::make_unique<ring>();
+	if (const auto error = m_ring->setup(entries, cq_entries); error)
+	{
+		return error;
+	}
+
+	// Pinning the buffers saves the kernel from mapping them on every operation,
+	// without enough locked memory the plain read and write operations are used instead.
+	auto iovecs = std::vector<iovec>{};
+	iovecs.reserve(m_connections.size());
+	for (auto& conn : m_connections)
+	{
+		iovecs.push_back({ &conn->buffers, sizeof(conn->buffers) });
+	}
+
+	m_stats.fixed_buffers = not iovecs.empty() and syscall(
+		__NR_io_uring_register,
+		m_ring->fd,
+		IORING_REGISTER_BUFFERS,
+		iovecs.data(),
+		static_cast<unsigned>(iovecs.size())
+	) == 0;
+
+	return {};
+}
+
+std::error_code deye::uring_fleet::poll(const callback_type& on_poll)
+{
+	if (m_setup_error)
+	{
+		return m_setup_error;
+	}
+
+	m_on_poll = &on_poll;
+
+	auto any_connecting = false;
+
+	for (auto& conn_ptr : m_connections)
+	{
+		auto& conn = *conn_ptr;
+
+		if (conn.config_error)
+		{
+			++m_stats.polls;
+			++m_stats.errors;
+			on_poll(conn.index, conn.values, conn.config_error);
+			continue;
+		}
+
+		conn.in_cycle = true;
+		conn.error = {};
+
+		if (conn.connected)
+		{
+			start_cycle(conn);
+		}
+		else if (const auto error = queue_connect(conn); error)
+		{
+			fail(conn, error);
+		}
+		else
+		{
+			any_connecting = true;
+		}
+
+		finish_if_done(conn);
+	}
+
+	// The receive timeout bounds the whole cycle, connecting devices get their connect timeout on top.
+	const auto timeout = m_timeouts.receive + (any_connecting ? m_timeouts.connect : std::chrono::milliseconds{});
+	const auto deadline = timeout.count() > 0 ? clock::now() + timeout : clock::time_point::max();
+
+	const auto error = run_until(deadline);
+
+	m_on_poll = nullptr;
+
+	return error;
+}
+
+std::error_code deye::uring_fleet::run_until(clock::time_point deadline)
+{
+	auto cancelled = false, shut_down = false;
+
+	while (m_in_flight != 0)
+	{
+		++m_stats.enters;
+		if (const auto error = m_ring->enter(1, deadline); error)
+		{
+			return error;
+		}
+
+		m_stats.completions += m_ring->for_each_completion([&](const std::uint64_t user_data, const std::int32_t result)
+		{
+			handle_completion(user_data, result);
+		});
+
+		if (m_in_flight == 0 or clock::now() < deadline)
+		{
+			continue;
+		}
+
+		if (not cancelled)
+		{
+			// Cancel everything that is still pending and give the kernel a moment to complete the cancellations.
+			for (auto& conn : m_connections)
+			{
+				if (conn->in_cycle and conn->busy())
+				{
+					fail(*conn, make_error_code(connector_error::codes::operation_timed_out));
+				}
+			}
+			cancelled = true;
+			deadline = clock::now() + cancel_grace_period;
+		}
+		else if (not shut_down)
+		{
+			// Operations that can't be cancelled anymore complete once their socket is shut down.
+			for (auto& conn : m_connections)
+			{
+				if (conn->in_cycle and conn->busy() and conn->fd >= 0)
+				{
+					shutdown(conn->fd, SHUT_RDWR);
+				}
+			}
+			shut_down = true;
+			deadline = clock::time_point::max();
+		}
+	}
+
+	return {};
+}
+
+void deye::uring_fleet::handle_completion(const std::uint64_t user_data, const std::int32_t result)
+{
+	--m_in_flight;
+
+	auto& conn = *m_connections[user_data >> 8];
+
+	switch (static_cast<operation>(user_data & 0xFF))
+	{
+	case operation::connect:
+		conn.connect_in_flight = false;
+		if (result < 0)
+		{
+			fail(conn, result == -ECANCELED ? conn.error : make_system_error(-result));
+		}
+		else if (not conn.error)
+		{
+			conn.connected = true;
+			start_cycle(conn);
+		}
+		break;
+	case operation::write:
+		conn.write_in_flight = false;
+		if (result < 0)
+		{
+			fail(conn, make_system_error(-result));
+		}
+		else if (not conn.error)
+		{
+			// Short writes send the rest of the queued frames.
+			conn.written_bytes += static_cast<std::size_t>(result);
+			queue_write(conn);
+		}
+		break;
+	case operation::read:
+		conn.read_in_flight = false;
+		if (result < 0)
+		{
+			fail(conn, make_system_error(-result));
+		}
+		else if (result == 0)
+		{
+			fail(conn, std::make_error_code(std::errc::connection_reset));
+		}
+		else if (not conn.error)
+		{
+			receive(conn, static_cast<std::size_t>(result));
+		}
+		break;
+	case operation::cancel:
+		--conn.cancels_in_flight;
+		break;
+	}
+
+	finish_if_done(conn);
+}
+
+void deye::uring_fleet::start_cycle(connection& conn)
+{
+	conn.first_sequence_number = conn.next_sequence_number;
+	conn.next_sequence_number += static_cast<std::uint8_t>(conn.ranges.size());
+
+	std::fill(conn.received.begin(), conn.received.end(), false);
+	conn.encoded_count = conn.received_count = conn.written_bytes = 0;
+
+	if (conn.ranges.empty())
+	{
+		return;
+	}
+
+	top_up(conn);
+	queue_read(conn);
+}
+
+void deye::uring_fleet::top_up(connection& conn)
+{
+	const auto pipeline_depth = std::max<std::size_t>(m_read_plan.max_frames_in_flight, 1);
+
+	// Requests are pre-encoded into consecutive slots, so all unsent ones go out with a single write.
+	for (; conn.encoded_count != conn.ranges.size() and conn.encoded_count - conn.received_count < pipeline_depth; ++conn.encoded_count)
+	{
+		const auto slot = std::span{ conn.buffers.send }.subspan(conn.encoded_count * connection::frame_size, connection::frame_size);
+
+		detail::modbus::frame_template::set_sequence_number(
+			slot,
+			static_cast<std::uint8_t>(conn.first_sequence_number + conn.encoded_count)
+		);
+	}
+
+	queue_write(conn);
+}
+
+io_uring_sqe* deye::uring_fleet::next_sqe()
+{
+	if (auto* sqe = m_ring->get_sqe())
+	{
+		return sqe;
+	}
+
+	// Flush the full submission queue without waiting for completions.
+	++m_stats.enters;
+	if (m_ring->enter(0, clock::time_point::max()))
+	{
+		return nullptr;
+	}
+
+	return m_ring->get_sqe();
+}
+
+std::error_code deye::uring_fleet::queue_connect(connection& conn)
+{
+	conn.fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (conn.fd < 0)
+	{
+		return make_system_error(errno);
+	}
+
+	if (int no_delay = true; setsockopt(conn.fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay)) != 0)
+	{
+		return make_system_error(errno);
+	}
+
+	auto* sqe = next_sqe();
+	if (not sqe)
+	{
+		return std::make_error_code(std::errc::no_buffer_space);
+	}
+
+	sqe->opcode = IORING_OP_CONNECT;
+	sqe->fd = conn.fd;
+	sqe->addr = reinterpret_cast<std::uint64_t>(&conn.address);
+	sqe->off = sizeof(conn.address);
+	sqe->user_data = make_user_data(conn.index, operation::connect);
+
+	conn.connect_in_flight = true;
+	++m_in_flight;
+	++m_stats.submissions;
+
+	return {};
+}
+
+void deye::uring_fleet::queue_write(connection& conn)
+{
+	const auto end = conn.encoded_count * connection::frame_size;
+	if (conn.write_in_flight or conn.written_bytes == end)
+	{
+		return;
+	}
+
+	auto* sqe = next_sqe();
+	if (not sqe)
+	{
+		fail(conn, std::make_error_code(std::errc::no_buffer_space));
+		return;
+	}
+
+	sqe->opcode = m_stats.fixed_buffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+	sqe->fd = conn.fd;
+	sqe->addr = reinterpret_cast<std::uint64_t>(conn.buffers.send.data() + conn.written_bytes);
+	sqe->len = static_cast<std::uint32_t>(end - conn.written_bytes);
+	sqe->buf_index = static_cast<std::uint16_t>(conn.index);
+	sqe->user_data = make_user_data(conn.index, operation::write);
+
+	conn.write_in_flight = true;
+	++m_in_flight;
+	++m_stats.submissions;
+}
+
+void deye::uring_fleet::queue_read(connection& conn)
+{
+	if (conn.read_in_flight)
+	{
+		return;
+	}
+
+	auto* sqe = next_sqe();
+	if (not sqe)
+	{
+		fail(conn, std::make_error_code(std::errc::no_buffer_space));
+		return;
+	}
+
+	const auto space = conn.buffers.receive.prepare();
+
+	sqe->opcode = m_stats.fixed_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ;
+	sqe->fd = conn.fd;
+	sqe->addr = reinterpret_cast<std::uint64_t>(space.data());
+	sqe->len = static_cast<std::uint32_t>(space.size());
+	sqe->buf_index = static_cast<std::uint16_t>(conn.index);
+	sqe->user_data = make_user_data(conn.index, operation::read);
+
+	conn.read_in_flight = true;
+	++m_in_flight;
+	++m_stats.submissions;
+}
+
+void deye::uring_fleet::queue_cancel(connection& conn)
+{
+	for (const auto& [in_flight, op] : {
+		std::pair{ conn.connect_in_flight, operation::connect },
+		std::pair{ conn.write_in_flight, operation::write },
+		std::pair{ conn.read_in_flight, operation::read }
+	}) {
+		if (not in_flight)
+		{
+			continue;
+		}
+
+		auto* sqe = next_sqe();
+		if (not sqe)
+		{
+			// The operation completes once the socket is shut down at the end of the grace period.
+			return;
+		}
+
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->addr = make_user_data(conn.index, op);
+		sqe->user_data = make_user_data(conn.index, operation::cancel);
+
+		++conn.cancels_in_flight;
+		++m_in_flight;
+		++m_stats.submissions;
+	}
+}
+
+void deye::uring_fleet::receive(connection& conn, const std::size_t size)
+{
+	using connector_error::make_error_code;
+	using connector_error::codes;
+
+	auto& decoder = conn.buffers.receive;
+	decoder.commit(size);
+
+	while (true)
+	{
+		const auto message = decoder.next(conn.info.serial_number);
+		if (not message)
+		{
+			fail(conn, message.error());
+			return;
+		}
+
+		if (message->empty())
+		{
+			break;
+		}
+
+		const auto range_index = static_cast<std::uint8_t>(
+			detail::modbus::header_sequence_number(*message) - conn.first_sequence_number
+		);
+
+		if (range_index >= conn.encoded_count or conn.received[range_index])
+		{
+			fail(conn, make_error_code(codes::response_wrong_sequence_number));
+			return;
+		}
+
+		const auto& range = conn.ranges[range_index];
+
+		const auto error = detail::modbus::decode_frame(*message, [&](std::span<std::uint8_t> response) -> std::error_code
+		{
+			if (const auto registers = detail::modbus::decode_read_response(response, range.register_count))
+			{
+				return detail::read_planner::decode_range(config::sensors, conn.info.sensor_ids, conn.values, range, *registers);
+			}
+			else
+			{
+				return registers.error();
+			}
+		});
+
+		if (error)
+		{
+			fail(conn, error);
+			return;
+		}
+
+		conn.received[range_index] = true;
+		++conn.received_count;
+	}
+
+	if (conn.received_count != conn.ranges.size())
+	{
+		top_up(conn);
+		if (not conn.error)
+		{
+			queue_read(conn);
+		}
+	}
+}
+
+void deye::uring_fleet::fail(connection& conn, const std::error_code error)
+{
+	if (not conn.error)
+	{
+		conn.error = error;
+		queue_cancel(conn);
+	}
+}
+
+void deye::uring_fleet::finish_if_done(connection& conn)
+{
+	if (not conn.in_cycle or conn.busy())
+	{
+		return;
+	}
+
+	if (not conn.error and conn.received_count != conn.ranges.size())
+	{
+		return;
+	}
+
+	conn.in_cycle = false;
+
+	++m_stats.polls;
+	if (conn.error)
+	{
+		// Start the next cycle with a fresh connection, the stream may be out of sync.
+		++m_stats.errors;
+		close(conn);
+	}
+
+	if (m_on_poll and *m_on_poll)
+	{
+		(*m_on_poll)(conn.index, conn.values, conn.error);
+	}
+}
+
+void deye::uring_fleet::close(connection& conn)
+{
+	if (conn.fd >= 0)
+	{
+		::close(conn.fd);
+		conn.fd = -1;
+	}
+	conn.connected = false;
+	conn.buffers.receive.reset();
+}
+
+void deye::uring_fleet::disconnect()
+{
+	for (auto& conn : m_connections)
+	{
+		close(*conn);
+	}
+}
+
+const deye::uring_stats& deye::uring_fleet::stats() const
+{
+	return m_stats;
+}
+
+deye::uring_fleet::~uring_fleet()
+{
+	disconnect();
+}
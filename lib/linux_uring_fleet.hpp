@@ -0,0 +1,130 @@
+/*
+* Copyright (C) 2025 ZY4N <me@zy4n.com>
+ *
+ * Licensed under GPLv2, see file LICENSE in this source tree.
+ */
+
+#pragma once
+
+#include "deye_fleet_poller.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <system_error>
+#include <vector>
+
+struct io_uring_sqe;
+
+namespace deye
+{
+
+struct uring_stats
+{
+	std::uint64_t polls{}, errors{};
+
+	// Every `io_uring_enter` call, the only system call of a poll cycle once all devices are connected.
+	std::uint64_t enters{};
+
+	std::uint64_t submissions{}, completions{};
+
+	// Whether the frame buffers could be registered with the kernel, see `RLIMIT_MEMLOCK` otherwise.
+	bool fixed_buffers{ false };
+};
+
+/**
+ * @brief Polls a whole fleet of loggers from one thread through a single io_uring instance.
+ *
+ * A poll cycle queues the read requests and receives of every device and submits them with one system call,
+ * completions are reaped in batches and the follow up operations of all devices go out with the next wait.
+ * The send and receive buffers of all connections are registered with the kernel once,
+ * so the per frame work of the kernel is reduced to the socket operation itself.
+ * Reads are pipelined four deep by default, failed devices are reconnected so late responses can't mix into the next cycle.
+ * Requires Linux 5.11 or newer.
+ */
+class uring_fleet
+{
+public:
+	/**
+	 * @brief Called after every device completed or failed its poll cycle.
+	 *
+	 * @param device_index The index of the device in the list given to the constructor.
+	 * @param values The values in the order of the devices `sensor_ids`, only valid if `error` is not set.
+	 */
+	using callback_type = std::function<void(
+		std::size_t device_index,
+		std::span<const sensor_value> values,
+		std::error_code error
+	)>;
+
+	explicit uring_fleet(
+		std::vector<fleet_device> devices,
+		read_plan_config read_plan = { .max_frames_in_flight = 4 },
+		timeout_config timeouts = {}
+	);
+
+	uring_fleet(const uring_fleet&) = delete;
+	uring_fleet& operator=(const uring_fleet&) = delete;
+
+	/**
+	 * @brief Reads every device once, (re)connecting devices that are not connected first.
+	 *
+	 * Errors of individual devices are passed to `on_poll`, the device is disconnected and
+	 * reconnected in the next cycle. The returned error is only set if the ring itself failed.
+	 */
+	[[nodiscard]] std::error_code poll(const callback_type& on_poll);
+
+	/**
+	 * @brief Closes all connections.
+	 */
+	void disconnect();
+
+	[[nodiscard]] const uring_stats& stats() const;
+
+	~uring_fleet();
+
+private:
+	struct ring;
+	struct connection;
+
+	[[nodiscard]] std::error_code setup();
+
+	[[nodiscard]] std::error_code run_until(std::chrono::steady_clock::time_point deadline);
+
+	void handle_completion(std::uint64_t user_data, std::int32_t result);
+
+	[[nodiscard]] io_uring_sqe* next_sqe();
+
+	[[nodiscard]] std::error_code queue_connect(connection& conn);
+
+	void queue_write(connection& conn);
+
+	void queue_read(connection& conn);
+
+	void queue_cancel(connection& conn);
+
+	void receive(connection& conn, std::size_t size);
+
+	void top_up(connection& conn);
+
+	void start_cycle(connection& conn);
+
+	void fail(connection& conn, std::error_code error);
+
+	void finish_if_done(connection& conn);
+
+	void close(connection& conn);
+
+	std::unique_ptr<ring> m_ring;
+	std::vector<std::unique_ptr<connection>> m_connections;
+	read_plan_config m_read_plan;
+	timeout_config m_timeouts;
+	std::error_code m_setup_error{};
+	std::size_t m_in_flight{};
+	const callback_type* m_on_poll{};
+	uring_stats m_stats{};
+};
+
+} // namespace deye
@@ -18,15 +18,55 @@ static inline std::error_code make_system_error(int code) {
 	return std::make_error_code(errc);
 }
 
+using deadline_clock = std::chrono::steady_clock;
+
+static inline deadline_clock::time_point make_deadline(std::chrono::milliseconds timeout) {
+	return timeout.count() > 0 ? deadline_clock::now() + timeout : deadline_clock::time_point::max();
+}
+
+// Blocks until the socket is ready for reading/writing or the deadline expired.
+static std::error_code wait_until(int fd, bool for_write, deadline_clock::time_point deadline) {
+	if (deadline == deadline_clock::time_point::max())
+		return {};
+
+	while (true) {
+		const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - deadline_clock::now());
+		if (remaining.count() <= 0)
+			return std::make_error_code(std::errc::timed_out);
+
+		struct timeval tv;
+		tv.tv_sec = static_cast<long>(remaining.count() / 1'000'000);
+		tv.tv_usec = static_cast<long>(remaining.count() % 1'000'000);
+
+		fd_set fds;
+		FD_ZERO(&fds);
+		FD_SET(fd, &fds);
+
+		const int ready = select(fd + 1, for_write ? nullptr : &fds, for_write ? &fds : nullptr, nullptr, &tv);
+		if (ready > 0)
+			return {};
+		if (ready == 0)
+			return std::make_error_code(std::errc::timed_out);
+		if (errno != EINTR)
+			return make_system_error(errno);
+	}
+}
+
 
 lwip_tcp_socket::lwip_tcp_socket(lwip_tcp_socket&& other) {
 	std::swap(other.m_fd, m_fd);
+	m_connect_timeout = other.m_connect_timeout;
+	m_send_timeout = other.m_send_timeout;
+	m_receive_timeout = other.m_receive_timeout;
 }
 
 lwip_tcp_socket& lwip_tcp_socket::operator=(lwip_tcp_socket&& other) {
 	if (&other != this) {
 		this->~lwip_tcp_socket();
 		std::swap(other.m_fd, m_fd);
+		m_connect_timeout = other.m_connect_timeout;
+		m_send_timeout = other.m_send_timeout;
+		m_receive_timeout = other.m_receive_timeout;
 	}
 	return *this;
 }
@@ -99,31 +139,69 @@ std::error_code lwip_tcp_socket::connect(const char* host, uint16_t port) {
 	if (conn_fd < 0)
 		return make_system_error(errno);
 
+	const auto deadline = make_deadline(m_connect_timeout);
+
+	// Without a timeout the connect blocks, otherwise it is started non blocking and awaited with select.
+	const int flags = fcntl(conn_fd, F_GETFL, 0);
+	if (deadline != deadline_clock::time_point::max())
+		fcntl(conn_fd, F_SETFL, flags | O_NONBLOCK);
+
 	if (::connect(conn_fd, (struct sockaddr *)&dest_addr, sizeof(dest_addr)) != 0) {
-		close(conn_fd);
-		return make_system_error(errno);
+		if (errno != EINPROGRESS) {
+			const auto error = make_system_error(errno);
+			close(conn_fd);
+			return error;
+		}
+
+		if (const auto error = wait_until(conn_fd, true, deadline); error) {
+			close(conn_fd);
+			return error;
+		}
+
+		int connect_errno = 0;
+		socklen_t len = sizeof(connect_errno);
+		if (getsockopt(conn_fd, SOL_SOCKET, SO_ERROR, &connect_errno, &len) != 0 or connect_errno != 0) {
+			close(conn_fd);
+			return make_system_error(connect_errno != 0 ? connect_errno : errno);
+		}
 	}
 
+	fcntl(conn_fd, F_SETFL, flags);
+
 	m_fd = conn_fd;
 	
 	return {};
 }
 
 std::error_code lwip_tcp_socket::send(std::span<const uint8_t> bytes_left) {
+	const auto deadline = make_deadline(m_send_timeout);
 	while (not bytes_left.empty()) {
+		if (auto error = wait_until(m_fd, true, deadline); error)
+			return error;
 		const auto sent = ::send(m_fd, bytes_left.data(), bytes_left.size(), 0);
-		if (sent <= 0 and errno != EINTR)
+		if (sent < 0) {
+			if (errno == EINTR)
+				continue;
 			return make_system_error(errno);
+		}
 		bytes_left = bytes_left.subspan(sent);
 	}
 	return {};
 }
 
 std::error_code lwip_tcp_socket::receive(std::span<uint8_t> bytes_left) {
+	const auto deadline = make_deadline(m_receive_timeout);
 	while (not bytes_left.empty()) {
+		if (auto error = wait_until(m_fd, false, deadline); error)
+			return error;
 		const auto received = recv(m_fd, bytes_left.data(), bytes_left.size(), 0);
-		if (received <= 0 and errno != EINTR)
+		if (received < 0) {
+			if (errno == EINTR)
+				continue;
 			return make_system_error(errno);
+		}
+		if (received == 0)
+			return std::make_error_code(std::errc::connection_reset);
 		bytes_left = bytes_left.subspan(received);
 	}
 	return {};
@@ -143,6 +221,33 @@ std::error_code lwip_tcp_socket::disconnect() {
 	return {};
 }
 
+std::expected<std::size_t, std::error_code> lwip_tcp_socket::receive_some(std::span<uint8_t> data) {
+	const auto deadline = make_deadline(m_receive_timeout);
+	while (true) {
+		if (auto error = wait_until(m_fd, false, deadline); error)
+			return std::unexpected{ error };
+		const auto received = recv(m_fd, data.data(), data.size(), 0);
+		if (received < 0) {
+			if (errno == EINTR)
+				continue;
+			return std::unexpected{ make_system_error(errno) };
+		}
+		if (received == 0)
+			return std::unexpected{ std::make_error_code(std::errc::connection_reset) };
+		return static_cast<std::size_t>(received);
+	}
+}
+
+void lwip_tcp_socket::set_timeouts(
+	std::chrono::milliseconds connect_timeout,
+	std::chrono::milliseconds send_timeout,
+	std::chrono::milliseconds receive_timeout
+) {
+	m_connect_timeout = connect_timeout;
+	m_send_timeout = send_timeout;
+	m_receive_timeout = receive_timeout;
+}
+
 lwip_tcp_socket::~lwip_tcp_socket() {
 	disconnect();
 }
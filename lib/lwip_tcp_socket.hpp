@@ -9,6 +9,8 @@
 #include <system_error>
 #include <cstdint>
 #include <span>
+#include <chrono>
+#include <expected>
 
 
 class lwip_tcp_socket {
@@ -29,10 +31,19 @@ public:
 
 	[[nodiscard]] std::error_code receive(std::span<uint8_t> data);
 
+	[[nodiscard]] std::expected<std::size_t, std::error_code> receive_some(std::span<uint8_t> data);
+
 	[[nodiscard]] std::error_code disconnect();
 
+	void set_timeouts(
+		std::chrono::milliseconds connect_timeout,
+		std::chrono::milliseconds send_timeout,
+		std::chrono::milliseconds receive_timeout
+	);
+
 	~lwip_tcp_socket();	
 
 private:
 	int m_fd{ -1 };
+	std::chrono::milliseconds m_connect_timeout{}, m_send_timeout{}, m_receive_timeout{};
 };